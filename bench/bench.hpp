@@ -0,0 +1,197 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// bench: minimal timing harness for the expected-lite benchmarks.
+
+#ifndef NONSTD_EXPECTED_BENCH_HPP
+#define NONSTD_EXPECTED_BENCH_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// keep a function out of line, so that its call is measured:
+
+#if defined(__GNUC__) || defined(__clang__)
+# define bench_NOINLINE  __attribute__((noinline))
+#elif defined(_MSC_VER)
+# define bench_NOINLINE  __declspec(noinline)
+#else
+# define bench_NOINLINE
+#endif
+
+namespace bench {
+
+/// keep the compiler from optimizing away a value or the computation of it.
+
+template< typename T >
+inline void do_not_optimize( T const & value )
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile( "" : : "r,m"( value ) : "memory" );
+#else
+    static volatile char sink;
+    sink = *reinterpret_cast<char const volatile *>( &value );
+#endif
+}
+
+/// command line settings common to all benchmarks.
+
+struct options
+{
+    std::size_t iterations = 1000000;   // calls per run
+    std::size_t runs       = 5;         // runs per benchmark; the fastest is reported
+    std::size_t threads    = 64;        // most threads of multi-threaded benchmarks
+    bool        json       = false;     // report as a JSON array instead of text
+};
+
+/// reports in JSON: an array of objects, closed at program exit.
+
+class json_writer
+{
+public:
+    json_writer() = default;
+    json_writer( json_writer const & ) = delete;
+    json_writer & operator=( json_writer const & ) = delete;
+
+    ~json_writer()
+    {
+        if ( m_enabled )
+            std::printf( m_count != 0 ? "\n]\n" : "[]\n" );
+    }
+
+    void enable( options const & opt )
+    {
+        m_enabled = opt.json;
+        m_opt     = opt;
+    }
+
+    bool enabled() const
+    {
+        return m_enabled;
+    }
+
+    /// write a report; p99_ns is omitted if negative.
+
+    void write( char const * name, double ns_per_op, double p99_ns = -1 )
+    {
+        std::printf( "%s\n  { \"name\": \"", m_count++ != 0 ? "," : "[" );
+
+        for ( char const * p = name; *p; ++p )
+        {
+            if ( *p == '"' || *p == '\\' )
+                std::putchar( '\\' );
+            std::putchar( *p );
+        }
+
+        std::printf( "\", \"ns_per_op\": %.3f", ns_per_op );
+
+        if ( p99_ns >= 0 )
+            std::printf( ", \"ops_per_s\": %.0f, \"p99_ns\": %.1f", 1e9 / ns_per_op, p99_ns );
+
+        std::printf( ", \"iterations\": %lu, \"runs\": %lu }"
+            , static_cast<unsigned long>( m_opt.iterations ), static_cast<unsigned long>( m_opt.runs ) );
+    }
+
+private:
+    bool        m_enabled = false;
+    std::size_t m_count   = 0;
+    options     m_opt;
+};
+
+inline json_writer & json()
+{
+    static json_writer writer;
+    return writer;
+}
+
+/// read --iterations n, --runs n, --threads n and --json.
+
+inline options parse( int argc, char * argv[] )
+{
+    options opt;
+
+    for ( int i = 1; i < argc; ++i )
+    {
+        if      ( 0 == std::strcmp( argv[i], "--json" ) )                        opt.json       = true;
+        else if ( 0 == std::strcmp( argv[i], "--iterations" ) && i + 1 < argc ) opt.iterations = std::strtoul( argv[++i], nullptr, 10 );
+        else if ( 0 == std::strcmp( argv[i], "--runs"       ) && i + 1 < argc ) opt.runs       = std::strtoul( argv[++i], nullptr, 10 );
+        else if ( 0 == std::strcmp( argv[i], "--threads"    ) && i + 1 < argc ) opt.threads    = std::strtoul( argv[++i], nullptr, 10 );
+    }
+
+    json().enable( opt );
+    return opt;
+}
+
+/// report the time per operation of a benchmark.
+
+inline void report( char const * name, double ns_per_op )
+{
+    if ( json().enabled() )
+        json().write( name, ns_per_op );
+    else
+        std::printf( "%-40s %10.2f ns/op\n", name, ns_per_op );
+}
+
+/// same, with the throughput that follows from it and the 99th percentile
+/// of the latency of a single operation.
+
+inline void report( char const * name, double ns_per_op, double p99_ns )
+{
+    if ( json().enabled() )
+        json().write( name, ns_per_op, p99_ns );
+    else
+        std::printf( "%-48s %10.2f ns/op %12.0f op/s %10.1f ns p99\n", name, ns_per_op, 1e9 / ns_per_op, p99_ns );
+}
+
+/// the 99th percentile of samples, which it reorders.
+
+inline double p99( std::vector<double> & samples )
+{
+    if ( samples.empty() )
+        return 0.0;
+
+    const std::size_t k = samples.size() * 99 / 100;
+
+    std::nth_element( samples.begin(), samples.begin() + static_cast<std::ptrdiff_t>( k ), samples.end() );
+    return samples[k];
+}
+
+/// call f( i ) for i in [0, iterations) in each of runs runs, and report the
+/// fastest run in nanoseconds per call.
+
+template< typename F >
+double run( char const * name, options const & opt, F f )
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector<double> ns_per_op;
+
+    for ( std::size_t r = 0; r != opt.runs; ++r )
+    {
+        const auto start = clock::now();
+
+        for ( std::size_t i = 0; i != opt.iterations; ++i )
+        {
+            f( i );
+        }
+
+        const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+        ns_per_op.push_back( elapsed.count() / static_cast<double>( (std::max)( opt.iterations, std::size_t( 1 ) ) ) );
+    }
+
+    const double best = ns_per_op.empty() ? 0.0 : *std::min_element( ns_per_op.begin(), ns_per_op.end() );
+
+    report( name, best );
+    return best;
+}
+
+} // namespace bench
+
+#endif // NONSTD_EXPECTED_BENCH_HPP
@@ -0,0 +1,79 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Compare co_await on expected with hand-written early returns.
+
+#include "bench.hpp"
+#include "nonstd/expected_coroutine.hpp"
+
+#include <cstdio>
+
+#if nsel_HAVE_COROUTINES
+
+using nonstd::expected;
+using nonstd::make_unexpected;
+
+namespace {
+
+#if defined(__GNUC__) || defined(__clang__)
+# define bench_NOINLINE  __attribute__((noinline))
+#elif defined(_MSC_VER)
+# define bench_NOINLINE  __declspec(noinline)
+#else
+# define bench_NOINLINE
+#endif
+
+// one error in every 64 inputs:
+
+bench_NOINLINE expected<int, int> step( std::size_t x )
+{
+    if ( ( x & 63u ) == 63u )
+        return make_unexpected( static_cast<int>( x ) );
+    return static_cast<int>( x & 0xffu );
+}
+
+expected<int, int> early_return( std::size_t x )
+{
+    auto a = step( x );
+    if ( ! a ) return make_unexpected( a.error() );
+
+    auto b = step( x + 1 );
+    if ( ! b ) return make_unexpected( b.error() );
+
+    auto c = step( x + 2 );
+    if ( ! c ) return make_unexpected( c.error() );
+
+    return *a + *b + *c;
+}
+
+expected<int, int> coroutine( std::size_t x )
+{
+    const int a = co_await step( x );
+    const int b = co_await step( x + 1 );
+    const int c = co_await step( x + 2 );
+
+    co_return a + b + c;
+}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    const bench::options opt = bench::parse( argc, argv );
+
+    bench::run( "expected: hand-written early return", opt, []( std::size_t i ) { bench::do_not_optimize( early_return( i ) ); } );
+    bench::run( "expected: co_await",                   opt, []( std::size_t i ) { bench::do_not_optimize( coroutine( i ) ); } );
+}
+
+#else
+
+int main()
+{
+    std::printf( "expected-coroutine: coroutines not available\n" );
+}
+
+#endif // nsel_HAVE_COROUTINES
+
+// end of file
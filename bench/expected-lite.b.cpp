@@ -0,0 +1,271 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected-lite-bench: the cost of the operations of nonstd::expected, and of
+// std::expected if available, and of reporting failure via expected, via an
+// exception and via an error code, at error rates of 0, 1, 10 and 50%.
+//
+// Use --json for output that can be stored and compared between versions.
+
+// measure nonstd::expected itself, also where it could be std::expected:
+
+#define nsel_CONFIG_SELECT_EXPECTED  nsel_EXPECTED_NONSTD
+
+#include "bench.hpp"
+#include "nonstd/expected.hpp"
+
+#if nsel_HAVE_STD_EXPECTED
+# include <expected>
+#endif
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const unsigned error_rates[] = { 0, 1, 10, 50 };    // percent
+
+// rate out of every 100 consecutive i are errors, spread over the hundred:
+
+inline bool is_error( std::size_t i, unsigned rate )
+{
+    return ( i * 37 ) % 100 < rate;
+}
+
+std::string label( std::string const & subject, char const * operation, unsigned rate )
+{
+    return subject + " " + operation + ", errors: " + std::to_string( rate ) + "%";
+}
+
+// expected types to compare:
+
+struct nonstd_family
+{
+    template< typename T, typename E >
+    using expected = nonstd::expected<T, E>;
+
+    template< typename E >
+    static nonstd::unexpected_type<E> unexpected( E e )
+    {
+        return nonstd::unexpected_type<E>( std::move( e ) );
+    }
+
+    static char const * name()
+    {
+        return "nonstd::expected";
+    }
+};
+
+#if nsel_HAVE_STD_EXPECTED
+
+struct std_family
+{
+    template< typename T, typename E >
+    using expected = std::expected<T, E>;
+
+    template< typename E >
+    static std::unexpected<E> unexpected( E e )
+    {
+        return std::unexpected<E>( std::move( e ) );
+    }
+
+    static char const * name()
+    {
+        return "std::expected";
+    }
+};
+
+#endif
+
+// values: an int, and a string too long for the small string buffer.
+
+template< typename T >
+T make_value( std::size_t i );
+
+template<>
+int make_value<int>( std::size_t i )
+{
+    return static_cast<int>( i );
+}
+
+template<>
+std::string make_value<std::string>( std::size_t i )
+{
+    return std::string( 24, static_cast<char>( 'a' + i % 26 ) );
+}
+
+// operations of expected<T,int>:
+
+template< typename Family, typename T >
+void bench_operations( bench::options const & opt, unsigned rate, char const * type )
+{
+    using result = typename Family::template expected<T, int>;
+
+    const std::size_t n = 1024;     // power of two
+
+    std::vector<T>      values;
+    std::vector<result> inputs;
+
+    for ( std::size_t i = 0; i != n; ++i )
+    {
+        values.push_back( make_value<T>( i ) );
+        inputs.push_back( is_error( i, rate ) ? result( Family::unexpected( static_cast<int>( i ) ) ) : result( values.back() ) );
+    }
+
+    std::vector<result> others( inputs.rbegin(), inputs.rend() );
+
+    const std::string subject  = std::string( Family::name() ) + "<" + type + ",int>";
+    const T           fallback = make_value<T>( 0 );
+
+    bench::run( label( subject, "construct", rate ).c_str(), opt, [&]( std::size_t i )
+    {
+        const std::size_t k = i & ( n - 1 );
+        result r = is_error( k, rate ) ? result( Family::unexpected( static_cast<int>( k ) ) ) : result( values[k] );
+        bench::do_not_optimize( r );
+    } );
+
+    bench::run( label( subject, "copy", rate ).c_str(), opt, [&]( std::size_t i )
+    {
+        result r( inputs[ i & ( n - 1 ) ] );
+        bench::do_not_optimize( r );
+    } );
+
+    bench::run( label( subject, "move and move back", rate ).c_str(), opt, [&]( std::size_t i )
+    {
+        result & source = inputs[ i & ( n - 1 ) ];
+        result r( std::move( source ) );
+        bench::do_not_optimize( r );
+        source = std::move( r );
+    } );
+
+    result target( fallback );
+
+    bench::run( label( subject, "copy assign", rate ).c_str(), opt, [&]( std::size_t i )
+    {
+        target = inputs[ i & ( n - 1 ) ];
+        bench::do_not_optimize( target );
+    } );
+
+    bench::run( label( subject, "swap", rate ).c_str(), opt, [&]( std::size_t i )
+    {
+        const std::size_t k = i & ( n - 1 );
+        inputs[k].swap( others[k] );
+        bench::do_not_optimize( inputs[k] );
+    } );
+
+    bench::run( label( subject, "value() or catch", rate ).c_str(), opt, [&]( std::size_t i )
+    {
+        try
+        {
+            bench::do_not_optimize( inputs[ i & ( n - 1 ) ].value() );
+        }
+        catch ( ... )
+        {
+            bench::do_not_optimize( i );
+        }
+    } );
+
+    bench::run( label( subject, "value_or", rate ).c_str(), opt, [&]( std::size_t i )
+    {
+        bench::do_not_optimize( inputs[ i & ( n - 1 ) ].value_or( fallback ) );
+    } );
+
+    bench::run( label( subject, "operator==", rate ).c_str(), opt, [&]( std::size_t i )
+    {
+        const std::size_t k = i & ( n - 1 );
+        bench::do_not_optimize( inputs[k] == others[k] );
+    } );
+}
+
+// reporting failure from a function that is not inlined:
+
+struct failure
+{
+    int code;
+};
+
+template< typename Family >
+bench_NOINLINE typename Family::template expected<int, int> parse_expected( std::size_t i, unsigned rate )
+{
+    if ( is_error( i, rate ) )
+        return Family::unexpected( static_cast<int>( i ) );
+
+    return static_cast<int>( i );
+}
+
+bench_NOINLINE int parse_throwing( std::size_t i, unsigned rate )
+{
+    if ( is_error( i, rate ) )
+        throw failure{ static_cast<int>( i ) };
+
+    return static_cast<int>( i );
+}
+
+bench_NOINLINE int parse_error_code( std::size_t i, unsigned rate, int & value )
+{
+    if ( is_error( i, rate ) )
+        return static_cast<int>( i ) | 1;
+
+    value = static_cast<int>( i );
+    return 0;
+}
+
+template< typename Family >
+void bench_expected_failure( bench::options const & opt, unsigned rate )
+{
+    bench::run( label( Family::name(), "reporting failure", rate ).c_str(), opt, [rate]( std::size_t i )
+    {
+        auto r = parse_expected<Family>( i, rate );
+        bench::do_not_optimize( r ? *r : r.error() );
+    } );
+}
+
+void bench_failure( bench::options const & opt, unsigned rate )
+{
+    bench_expected_failure<nonstd_family>( opt, rate );
+#if nsel_HAVE_STD_EXPECTED
+    bench_expected_failure<std_family>( opt, rate );
+#endif
+
+    bench::run( label( "exception", "reporting failure", rate ).c_str(), opt, [rate]( std::size_t i )
+    {
+        try
+        {
+            bench::do_not_optimize( parse_throwing( i, rate ) );
+        }
+        catch ( failure const & f )
+        {
+            bench::do_not_optimize( f.code );
+        }
+    } );
+
+    bench::run( label( "error code", "reporting failure", rate ).c_str(), opt, [rate]( std::size_t i )
+    {
+        int value = 0;
+        const int code = parse_error_code( i, rate, value );
+        bench::do_not_optimize( code ? code : value );
+    } );
+}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    const bench::options opt = bench::parse( argc, argv );
+
+    for ( unsigned rate : error_rates )
+    {
+        bench_operations<nonstd_family, int        >( opt, rate, "int" );
+        bench_operations<nonstd_family, std::string>( opt, rate, "std::string" );
+#if nsel_HAVE_STD_EXPECTED
+        bench_operations<std_family, int        >( opt, rate, "int" );
+        bench_operations<std_family, std::string>( opt, rate, "std::string" );
+#endif
+        bench_failure( opt, rate );
+    }
+}
+
+// end of file
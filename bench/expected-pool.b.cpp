@@ -0,0 +1,80 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Compare running tasks via async_expected and via std::async.
+
+#include "bench.hpp"
+#include "nonstd/expected_pool.hpp"
+
+#include <future>
+#include <vector>
+
+using nonstd::expected;
+using nonstd::expected_future;
+using nonstd::work_stealing_pool;
+
+int main( int argc, char * argv[] )
+{
+    bench::options opt = bench::parse( argc, argv );
+
+    // a thread per task is expensive; use fewer iterations unless asked otherwise.
+
+    if ( opt.iterations == bench::options().iterations )
+        opt.iterations = 10000;
+
+    const std::size_t batch = 64;
+
+    // a batch of tasks in flight at a time.
+
+    bench::run( "batch: std::async", opt, [batch]( std::size_t i )
+    {
+        if ( i % batch != 0 )
+            return;
+
+        std::vector< std::future<int> > futures;
+
+        for ( std::size_t k = 0; k != batch; ++k )
+            futures.push_back( std::async( std::launch::async, [k]{ return static_cast<int>( k ); } ) );
+
+        for ( auto & f : futures )
+            bench::do_not_optimize( f.get() );
+    } );
+
+    work_stealing_pool pool;
+
+    bench::run( "batch: async_expected", opt, [batch, &pool]( std::size_t i )
+    {
+        if ( i % batch != 0 )
+            return;
+
+        std::vector< expected_future<int, std::exception_ptr> > futures;
+
+        for ( std::size_t k = 0; k != batch; ++k )
+            futures.push_back( async_expected( pool, [k]{ return static_cast<int>( k ); } ) );
+
+        for ( auto & f : futures )
+            bench::do_not_optimize( f.get() );
+    } );
+
+    // a chain of two steps.
+
+    bench::run( "chain: std::async", opt, []( std::size_t i )
+    {
+        auto first = std::async( std::launch::async, [i]{ return static_cast<int>( i ); } ).share();
+        auto second = std::async( std::launch::async, [first]{ return first.get() + 1; } );
+
+        bench::do_not_optimize( second.get() );
+    } );
+
+    bench::run( "chain: async_expected + then", opt, [&pool]( std::size_t i )
+    {
+        auto second = async_expected( pool, [i]{ return static_cast<int>( i ); } )
+            .then( []( expected<int, std::exception_ptr> e ) { return *e + 1; } );
+
+        bench::do_not_optimize( second.get() );
+    } );
+}
+
+// end of file
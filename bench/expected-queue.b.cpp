@@ -0,0 +1,148 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Throughput of expected_queue and of a mutex-protected std::deque, with
+// 1 to --threads (64) threads, half producing and half consuming.
+
+#include "bench.hpp"
+#include "nonstd/expected_queue.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using nonstd::expected;
+using nonstd::expected_queue;
+using nonstd::expected_vector;
+using nonstd::make_unexpected;
+
+namespace {
+
+using result = expected<long, int>;
+
+// one error in every 64 elements:
+
+inline bool is_error( std::size_t i )
+{
+    return ( i & 63u ) == 63u;
+}
+
+class locked_deque
+{
+public:
+    bool try_push( result && r )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        m_deque.push_back( std::move( r ) );
+        return true;
+    }
+
+    std::size_t try_pop_n( std::vector<result> & out, std::size_t n )
+    {
+        std::lock_guard<std::mutex> lock( m_mutex );
+        std::size_t count = 0;
+
+        for ( ; count != n && ! m_deque.empty(); ++count )
+        {
+            out.push_back( std::move( m_deque.front() ) );
+            m_deque.pop_front();
+        }
+        return count;
+    }
+
+private:
+    std::mutex         m_mutex;
+    std::deque<result> m_deque;
+};
+
+template< typename Queue, typename Batch >
+double run( Queue & queue, std::size_t threads, std::size_t items )
+{
+    const std::size_t producers = (std::max)( std::size_t( 1 ), threads / 2 );
+    const std::size_t consumers = (std::max)( std::size_t( 1 ), threads - producers );
+    const std::size_t per_producer = items / producers;
+    const std::size_t total = per_producer * producers;
+
+    std::atomic<std::size_t> consumed( 0 );
+    std::vector<std::thread> workers;
+
+    const auto start = std::chrono::steady_clock::now();
+
+    for ( std::size_t p = 0; p != producers; ++p )
+    {
+        workers.emplace_back( [&queue, per_producer]
+        {
+            for ( std::size_t i = 0; i != per_producer; ++i )
+            {
+                result r = is_error( i ) ? result( make_unexpected( 1 ) ) : result( static_cast<long>( i ) );
+
+                while ( ! queue.try_push( std::move( r ) ) )
+                    std::this_thread::yield();
+            }
+        } );
+    }
+
+    for ( std::size_t c = 0; c != consumers; ++c )
+    {
+        workers.emplace_back( [&queue, &consumed, total]
+        {
+            Batch batch;
+
+            while ( consumed.load( std::memory_order_relaxed ) < total )
+            {
+                batch.clear();
+                const std::size_t n = queue.try_pop_n( batch, 32 );
+
+                if ( n == 0 ) std::this_thread::yield();
+                else          consumed.fetch_add( n, std::memory_order_relaxed );
+
+                bench::do_not_optimize( batch );
+            }
+        } );
+    }
+
+    for ( auto & w : workers )
+        w.join();
+
+    const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / static_cast<double>( total );
+}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    const bench::options opt = bench::parse( argc, argv );
+
+    for ( std::size_t threads = 1; threads <= opt.threads; threads *= 2 )
+    {
+        double queue_best = 0;
+        double deque_best = 0;
+
+        for ( std::size_t r = 0; r != opt.runs; ++r )
+        {
+            expected_queue<long, int> queue( 1024 );
+            locked_deque deque;
+
+            const double q = run< expected_queue<long, int>, expected_vector<long, int> >( queue, threads, opt.iterations );
+            const double d = run< locked_deque, std::vector<result> >( deque, threads, opt.iterations );
+
+            queue_best = r == 0 ? q : (std::min)( queue_best, q );
+            deque_best = r == 0 ? d : (std::min)( deque_best, d );
+        }
+
+        const std::string n = std::to_string( threads );
+
+        bench::report( ( "expected_queue, threads: " + n ).c_str(), queue_best );
+        bench::report( ( "mutex, std::deque, threads: " + n ).c_str(), deque_best );
+    }
+}
+
+// end of file
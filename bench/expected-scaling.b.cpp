@@ -0,0 +1,198 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Throughput and 99th percentile latency of failing calls with 1 to
+// --threads (64) threads, where each call reports its error via
+// expected<T,E>, via expected<T, std::exception_ptr> from a throwing
+// function, or via a thrown exception. Unwinding may serialize threads on
+// a lock of the unwinder (e.g. in _Unwind_Find_FDE); returning an expected
+// does not.
+//
+// Each thread makes --iterations / 100 calls, all of which fail; latency is
+// measured per call with the steady clock, which adds its own overhead.
+
+#include "bench.hpp"
+#include "nonstd/expected.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+
+using nonstd::expected;
+using nonstd::make_unexpected;
+
+namespace {
+
+struct failure
+{
+    int code;
+};
+
+// a few frames for the error to pass, as in a real call chain:
+
+bench_NOINLINE expected<int, int> parse_expected( int depth, int i )
+{
+    if ( depth == 0 )
+        return make_unexpected( i );
+
+    auto r = parse_expected( depth - 1, i + 1 );
+
+    if ( ! r )
+        return make_unexpected( r.error() );
+
+    return *r + 1;
+}
+
+bench_NOINLINE int parse_throwing( int depth, int i )
+{
+    if ( depth == 0 )
+        throw failure{ i };
+
+    return parse_throwing( depth - 1, i + 1 ) + 1;
+}
+
+const int depth = 4;
+
+#if nsel_P0323R <= 2
+
+using nonstd::make_expected_from_call;
+
+#else
+
+// make_expected_from_call() of P0323R2 and earlier:
+
+template< typename F >
+auto make_expected_from_call( F f ) -> expected< decltype( f() ), std::exception_ptr >
+{
+    try
+    {
+        return f();
+    }
+    catch (...)
+    {
+        return make_unexpected( std::current_exception() );
+    }
+}
+
+#endif
+
+// run calls on threads threads; yield the time per call, over all threads,
+// and the latency of each call.
+
+template< typename F >
+double run( std::size_t threads, std::size_t calls, std::vector<double> & latencies, F f )
+{
+    using clock = std::chrono::steady_clock;
+
+    std::vector< std::vector<double> > samples( threads );
+    std::vector< std::thread > workers;
+    std::atomic<std::size_t> ready( 0 );
+    std::atomic<bool> go( false );
+
+    for ( std::size_t t = 0; t != threads; ++t )
+    {
+        samples[t].reserve( calls );
+
+        workers.emplace_back( [&, t]
+        {
+            ready.fetch_add( 1 );
+
+            while ( ! go.load() )
+                std::this_thread::yield();
+
+            for ( std::size_t i = 0; i != calls; ++i )
+            {
+                const auto start = clock::now();
+                f( static_cast<int>( i ) );
+                const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+
+                samples[t].push_back( elapsed.count() );
+            }
+        } );
+    }
+
+    while ( ready.load() != threads )
+        std::this_thread::yield();
+
+    const auto start = clock::now();
+    go.store( true );
+
+    for ( auto & w : workers )
+        w.join();
+
+    const std::chrono::duration<double, std::nano> elapsed = clock::now() - start;
+
+    latencies.clear();
+
+    for ( auto const & s : samples )
+        latencies.insert( latencies.end(), s.begin(), s.end() );
+
+    return elapsed.count() / static_cast<double>( threads * calls );
+}
+
+// report the run with the highest throughput of opt.runs runs.
+
+template< typename F >
+void measure( char const * name, bench::options const & opt, std::size_t threads, F f )
+{
+    const std::size_t calls = (std::max)( opt.iterations / 100, std::size_t( 1 ) );
+
+    double best_ns  = 0;
+    double best_p99 = 0;
+    std::vector<double> latencies;
+
+    for ( std::size_t r = 0; r != opt.runs; ++r )
+    {
+        const double ns = run( threads, calls, latencies, f );
+
+        if ( r == 0 || ns < best_ns )
+        {
+            best_ns  = ns;
+            best_p99 = bench::p99( latencies );
+        }
+    }
+
+    const std::string label = std::string( name ) + ", threads: " + std::to_string( threads );
+
+    bench::report( label.c_str(), best_ns, best_p99 );
+}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    const bench::options opt = bench::parse( argc, argv );
+
+    for ( std::size_t threads = 1; threads <= opt.threads; threads *= 2 )
+    {
+        measure( "expected<int,int>", opt, threads, []( int i )
+        {
+            bench::do_not_optimize( parse_expected( depth, i ) );
+        } );
+
+        measure( "expected<int,exception_ptr> from call", opt, threads, []( int i )
+        {
+            bench::do_not_optimize( make_expected_from_call( [i]{ return parse_throwing( depth, i ); } ) );
+        } );
+
+        measure( "throw", opt, threads, []( int i )
+        {
+            try
+            {
+                bench::do_not_optimize( parse_throwing( depth, i ) );
+            }
+            catch ( failure const & e )
+            {
+                bench::do_not_optimize( e.code );
+            }
+        } );
+    }
+}
+
+// end of file
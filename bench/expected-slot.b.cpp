@@ -0,0 +1,76 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Compare handing over an expected via expected_slot and via std::promise.
+
+#include "bench.hpp"
+#include "nonstd/expected_slot.hpp"
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+using nonstd::expected;
+using nonstd::expected_slot;
+
+using result = expected<int, int>;
+
+int main( int argc, char * argv[] )
+{
+    const bench::options opt = bench::parse( argc, argv );
+
+    // set and get on the same thread: the cost of the handoff itself.
+
+    bench::run( "handoff: std::promise", opt, []( std::size_t i )
+    {
+        std::promise<result> promise;
+        std::future<result>  future = promise.get_future();
+
+        promise.set_value( result( static_cast<int>( i ) ) );
+        bench::do_not_optimize( future.get() );
+    } );
+
+    expected_slot<int, int> slot;
+
+    bench::run( "handoff: expected_slot", opt, [&slot]( std::size_t i )
+    {
+        slot.set_value( static_cast<int>( i ) );
+        bench::do_not_optimize( slot.get() );
+        slot.reset();
+    } );
+
+    // round trip to an echo thread and back.
+
+    expected_slot<int, int> request;
+    expected_slot<int, int> response;
+    std::atomic<bool> done( false );
+
+    std::thread echo( [&]
+    {
+        for (;;)
+        {
+            const result r = request.get();
+            request.reset();
+
+            if ( done.load() )
+                return;
+
+            response.set_result( r );
+        }
+    } );
+
+    bench::run( "round trip: expected_slot", opt, [&]( std::size_t i )
+    {
+        request.set_value( static_cast<int>( i ) );
+        bench::do_not_optimize( response.get() );
+        response.reset();
+    } );
+
+    done.store( true );
+    request.set_value( 0 );
+    echo.join();
+}
+
+// end of file
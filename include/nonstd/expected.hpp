@@ -66,6 +66,19 @@
 # define nsel_P0323R  7
 #endif
 
+// Store error types larger than this many bytes out of line (0: never):
+
+#ifndef  nsel_CONFIG_BOXED_ERROR_THRESHOLD
+# define nsel_CONFIG_BOXED_ERROR_THRESHOLD  0
+#endif
+
+// Use the common specializations and rethrow helpers compiled in library
+// expected-lite-instantiations rather than instantiate them per translation unit:
+
+#ifndef  nsel_CONFIG_EXTERN_INSTANTIATIONS
+# define nsel_CONFIG_EXTERN_INSTANTIATIONS  0
+#endif
+
 // Control presence of C++ exception handling (try and auto discover):
 
 #ifndef nsel_CONFIG_NO_EXCEPTIONS
@@ -102,14 +115,17 @@
 #define nsel_CPP17_OR_GREATER  ( nsel_CPLUSPLUS >= 201703L )
 #define nsel_CPP20_OR_GREATER  ( nsel_CPLUSPLUS >= 202000L )
 
-// Use C++20 std::expected if available and requested:
+// Use std::expected if available and requested; the library feature macro
+// tells, as <expected> may exist but be empty before C++23:
 
 #if nsel_CPP20_OR_GREATER && defined(__has_include )
-# if __has_include( <expected> )
-#  define nsel_HAVE_STD_EXPECTED  1
-# else
-#  define nsel_HAVE_STD_EXPECTED  0
+# if __has_include( <version> )
+#  include <version>
 # endif
+#endif
+
+#if defined(__cpp_lib_expected) && __cpp_lib_expected >= 202211L
+# define  nsel_HAVE_STD_EXPECTED  1
 #else
 # define  nsel_HAVE_STD_EXPECTED  0
 #endif
@@ -215,6 +231,10 @@ inline in_place_t in_place_index( detail::in_place_index_tag<K> = detail::in_pla
 namespace nonstd {
 
     using std::expected;
+    using std::unexpected;
+    using std::unexpect_t;
+    using std::unexpect;
+    using std::bad_expected_access;
 //  ...
 }
 
@@ -230,6 +250,10 @@ namespace nonstd {
 #include <type_traits>
 #include <utility>
 
+#if nsel_CONFIG_EXTERN_INSTANTIATIONS
+# include <string>
+#endif
+
 // additional includes:
 
 #if nsel_CONFIG_NO_EXCEPTIONS
@@ -262,6 +286,29 @@ namespace nonstd {
 # define nsel_inline17 /*inline*/
 #endif
 
+// C++20: constant evaluation of std::construct_at, of a change of the active
+// union member and of destructors (P0784, P1330):
+
+#if nsel_CPP20_OR_GREATER && defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_constexpr_dynamic_alloc)
+# define nsel_HAVE_CONSTEXPR_20  1
+#else
+# define nsel_HAVE_CONSTEXPR_20  0
+#endif
+
+#if nsel_HAVE_CONSTEXPR_20
+# define nsel_constexpr20 constexpr
+#else
+# define nsel_constexpr20 /*constexpr*/
+#endif
+
+// C++20: conditionally trivial special member functions (P0848):
+
+#if nsel_CPP20_OR_GREATER && defined(__cpp_concepts) && __cpp_concepts >= 202002L
+# define nsel_HAVE_CONDITIONALLY_TRIVIAL  1
+#else
+# define nsel_HAVE_CONDITIONALLY_TRIVIAL  0
+#endif
+
 // Compiler versions:
 //
 // MSVC++  6.0  _MSC_VER == 1200  nsel_COMPILER_MSVC_VERSION ==  60  (Visual Studio 6.0)
@@ -368,6 +415,7 @@ namespace std17 {
 #if nsel_CPP17_OR_GREATER
 
 using std::conjunction;
+using std::negation;
 using std::is_swappable;
 using std::is_nothrow_swappable;
 
@@ -420,6 +468,11 @@ template< typename B1 > struct conjunction<B1> : B1{};
 template< typename B1, typename... Bn >
 struct conjunction<B1, Bn...> : std::conditional<bool(B1::value), conjunction<Bn...>, B1>::type{};
 
+// negation:
+
+template< typename B >
+struct negation : std::integral_constant<bool, !bool(B::value)>{};
+
 #endif // nsel_CPP17_OR_GREATER
 
 } // namespace std17
@@ -444,6 +497,188 @@ struct remove_cvref
 
 } // namespace std20
 
+/// class boxed: holds an error out of line, allocated via Alloc.
+/// A moved-from boxed is valueless; it can only be assigned to, compared or
+/// destroyed. Accessing its error is a precondition violation, asserted.
+
+template< typename E, typename Alloc = std::allocator<E> >
+class boxed : private Alloc
+{
+    using alloc_traits = std::allocator_traits<Alloc>;
+
+    static_assert( std::is_same<typename alloc_traits::value_type, E>::value, "boxed<E, Alloc>: Alloc::value_type must be E" );
+
+public:
+    using value_type     = E;
+    using allocator_type = Alloc;
+    using pointer        = typename alloc_traits::pointer;
+
+    template< typename... Args >
+    explicit boxed( nonstd_lite_in_place_t(E), Args&&... args )
+        : Alloc()
+        , m_ptr( create( std::forward<Args>( args )... ) )
+    {}
+
+    template< typename... Args >
+    boxed( std::allocator_arg_t, Alloc const & alloc, nonstd_lite_in_place_t(E), Args&&... args )
+        : Alloc( alloc )
+        , m_ptr( create( std::forward<Args>( args )... ) )
+    {}
+
+    /*non-explicit*/ boxed( E const & error )
+        : Alloc()
+        , m_ptr( create( error ) )
+    {}
+
+    /*non-explicit*/ boxed( E && error )
+        : Alloc()
+        , m_ptr( create( std::move( error ) ) )
+    {}
+
+    boxed( boxed const & other )
+        : Alloc( alloc_traits::select_on_container_copy_construction( other.get_allocator() ) )
+        , m_ptr( other.m_ptr ? create( *other ) : pointer() )
+    {}
+
+    boxed( boxed && other ) noexcept
+        : Alloc( std::move( other.alloc() ) )
+        , m_ptr( other.m_ptr )
+    {
+        other.m_ptr = pointer();
+    }
+
+    ~boxed()
+    {
+        destroy();
+    }
+
+    boxed & operator=( boxed const & other )
+    {
+        boxed( other ).swap( *this );
+        return *this;
+    }
+
+    boxed & operator=( boxed && other ) noexcept
+    {
+        boxed( std::move( other ) ).swap( *this );
+        return *this;
+    }
+
+    void swap( boxed & other ) noexcept
+    {
+        using std::swap;
+        swap( alloc(), other.alloc() );
+        swap( m_ptr, other.m_ptr );
+    }
+
+    E & operator*() const
+    {
+        return assert( m_ptr ), *m_ptr;
+    }
+
+    E * operator->() const
+    {
+        return assert( m_ptr ), std::addressof( *m_ptr );
+    }
+
+    E & get() const
+    {
+        return **this;
+    }
+
+    bool valueless_after_move() const noexcept
+    {
+        return m_ptr == pointer();
+    }
+
+    allocator_type get_allocator() const
+    {
+        return alloc();
+    }
+
+private:
+    Alloc & alloc() noexcept
+    {
+        return *this;
+    }
+
+    Alloc const & alloc() const noexcept
+    {
+        return *this;
+    }
+
+    template< typename... Args >
+    pointer create( Args&&... args )
+    {
+        pointer p = alloc_traits::allocate( alloc(), 1 );
+#if nsel_CONFIG_NO_EXCEPTIONS
+        alloc_traits::construct( alloc(), std::addressof( *p ), std::forward<Args>( args )... );
+#else
+        try
+        {
+            alloc_traits::construct( alloc(), std::addressof( *p ), std::forward<Args>( args )... );
+        }
+        catch (...)
+        {
+            alloc_traits::deallocate( alloc(), p, 1 );
+            throw;
+        }
+#endif
+        return p;
+    }
+
+    void destroy()
+    {
+        if ( m_ptr )
+        {
+            alloc_traits::destroy( alloc(), std::addressof( *m_ptr ) );
+            alloc_traits::deallocate( alloc(), m_ptr, 1 );
+        }
+    }
+
+private:
+    pointer m_ptr;
+};
+
+template< typename E, typename A >
+void swap( boxed<E, A> & x, boxed<E, A> & y ) noexcept
+{
+    x.swap( y );
+}
+
+// valueless boxes compare equal to each other and unequal to any error:
+
+template< typename E, typename A1, typename A2 >
+bool operator==( boxed<E, A1> const & x, boxed<E, A2> const & y )
+{
+    return x.valueless_after_move() || y.valueless_after_move()
+        ? x.valueless_after_move() == y.valueless_after_move()
+        : *x == *y;
+}
+
+template< typename E, typename A1, typename A2 >
+bool operator!=( boxed<E, A1> const & x, boxed<E, A2> const & y )
+{
+    return !( x == y );
+}
+
+/// Select out-of-line storage for an error type; specialize to opt a type in or out.
+
+template< typename E >
+struct is_boxed_error : std::integral_constant< bool,
+    ( nsel_CONFIG_BOXED_ERROR_THRESHOLD > 0 ) && ( sizeof(E) > std::size_t( nsel_CONFIG_BOXED_ERROR_THRESHOLD ) ) > {};
+
+template< typename E, typename A >
+struct is_boxed_error< boxed<E, A> > : std::false_type {};
+
+/// Allocator for automatically boxed errors; specialize to plug in another.
+
+template< typename E >
+struct boxed_error_allocator
+{
+    using type = std::allocator<E>;
+};
+
 // forward declaration:
 
 template< typename T, typename E >
@@ -451,6 +686,118 @@ class expected;
 
 namespace detail {
 
+/// T is constructible or convertible from W in any of its value categories.
+/// Used by the converting constructors of unexpected_type and expected: each
+/// instantiation of a class copies the constraints of its member templates,
+/// so naming this check once keeps them short.
+
+template< typename T, typename W >
+struct is_convertible_from_any : std::integral_constant< bool,
+    std::is_constructible<   T, W       &    >::value
+    || std::is_constructible<T, W       &&   >::value
+    || std::is_constructible<T, W const &    >::value
+    || std::is_constructible<T, W const &&   >::value
+    || std::is_convertible<     W       & , T>::value
+    || std::is_convertible<     W       &&, T>::value
+    || std::is_convertible<     W const & , T>::value
+    || std::is_convertible<     W const &&, T>::value
+>{};
+
+/// construct a T at where; in constant expressions too as of C++20.
+
+template< typename T, typename... Args >
+nsel_constexpr20 T * construct_at( T * where, Args&&... args )
+{
+#if nsel_HAVE_CONSTEXPR_20
+    return std::construct_at( where, std::forward<Args>( args )... );
+#else
+    return ::new( static_cast<void *>( where ) ) T( std::forward<Args>( args )... );
+#endif
+}
+
+/// error as held in storage: in place, or boxed when is_boxed_error<E>.
+
+template< typename E, bool = is_boxed_error<E>::value >
+struct error_storage
+{
+    using type = E;
+
+    template< typename... Args >
+    static nsel_constexpr20 void construct( type * where, Args&&... args )
+    {
+        detail::construct_at( where, std::forward<Args>( args )... );
+    }
+
+    static constexpr E const & get( type const & e )
+    {
+        return e;
+    }
+
+    static nsel_constexpr14 E & get( type & e )
+    {
+        return e;
+    }
+};
+
+template< typename E >
+struct error_storage< E, true >
+{
+    using type = boxed< E, typename boxed_error_allocator<E>::type >;
+
+    template< typename... Args >
+    static void construct( type * where, Args&&... args )
+    {
+        new( where ) type( nonstd_lite_in_place(E), std::forward<Args>( args )... );
+    }
+
+    static E const & get( type const & e )
+    {
+        return *e;
+    }
+
+    static E & get( type & e )
+    {
+        return *e;
+    }
+};
+
+/// moving a boxed error allocates a new box, so it may throw.
+
+template< typename E >
+struct is_nothrow_error_move_constructible : std::integral_constant< bool,
+    std::is_nothrow_move_constructible<E>::value && !is_boxed_error<E>::value > {};
+
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+
+/// the special members of expected<T,E> that may be trivial, as those of
+/// std::expected: the ones that T, unless void, and the stored E have trivial.
+
+template< typename T, typename E, typename S = typename error_storage<E>::type >
+struct trivially
+{
+    static constexpr bool destructible =
+        ( std::is_void<T>::value || std::is_trivially_destructible<T>::value )
+        && std::is_trivially_destructible<S>::value;
+
+    static constexpr bool copy_constructible =
+        ( std::is_void<T>::value || std::is_trivially_copy_constructible<T>::value )
+        && std::is_trivially_copy_constructible<S>::value;
+
+    static constexpr bool move_constructible =
+        ( std::is_void<T>::value || std::is_trivially_move_constructible<T>::value )
+        && std::is_trivially_move_constructible<S>::value;
+
+    static constexpr bool copy_assignable = copy_constructible && destructible
+        && ( std::is_void<T>::value || std::is_trivially_copy_assignable<T>::value )
+        && std::is_trivially_copy_assignable<S>::value;
+
+    static constexpr bool move_assignable = move_constructible && destructible
+        && ( std::is_void<T>::value || std::is_trivially_move_assignable<T>::value )
+        && std::is_trivially_move_assignable<S>::value;
+};
+
+#endif // nsel_HAVE_CONDITIONALLY_TRIVIAL
+
 /// discriminated union to hold value or 'error'.
 
 template< typename T, typename E >
@@ -461,67 +808,96 @@ class storage_t_impl
 public:
     using value_type = T;
     using error_type = E;
+    using stored_error_type = typename error_storage<E>::type;
 
     // no-op construction
-    storage_t_impl() {}
-    ~storage_t_impl() {}
+    nsel_constexpr20 storage_t_impl() {}
+    nsel_constexpr20 ~storage_t_impl() {}
+
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    ~storage_t_impl() requires detail::trivially<T, E>::destructible = default;
+
+    storage_t_impl( storage_t_impl const & ) = default;
+    storage_t_impl( storage_t_impl && ) = default;
+    storage_t_impl & operator=( storage_t_impl const & ) = default;
+    storage_t_impl & operator=( storage_t_impl && ) = default;
+#endif
 
-    explicit storage_t_impl( bool has_value )
+    nsel_constexpr20 explicit storage_t_impl( bool has_value )
         : m_has_value( has_value )
     {}
 
-    void construct_value( value_type const & e )
+    nsel_constexpr20 void construct_value( value_type const & e )
     {
-        new( &m_value ) value_type( e );
+        detail::construct_at( &m_value, e );
     }
 
-    void construct_value( value_type && e )
+    nsel_constexpr20 void construct_value( value_type && e )
     {
-        new( &m_value ) value_type( std::move( e ) );
+        detail::construct_at( &m_value, std::move( e ) );
     }
 
     template< class... Args >
-    void emplace_value( Args&&... args )
+    nsel_constexpr20 void emplace_value( Args&&... args )
     {
-        new( &m_value ) value_type( std::forward<Args>(args)...);
+        detail::construct_at( &m_value, std::forward<Args>(args)... );
     }
 
     template< class U, class... Args >
-    void emplace_value( std::initializer_list<U> il, Args&&... args )
+    nsel_constexpr20 void emplace_value( std::initializer_list<U> il, Args&&... args )
     {
-        new( &m_value ) value_type( il, std::forward<Args>(args)... );
+        detail::construct_at( &m_value, il, std::forward<Args>(args)... );
     }
 
-    void destruct_value()
+    nsel_constexpr20 void destruct_value()
     {
         m_value.~value_type();
     }
 
-    void construct_error( error_type const & e )
+    nsel_constexpr20 void construct_error( error_type const & e )
     {
-        new( &m_error ) error_type( e );
+        error_storage<E>::construct( &m_error, e );
     }
 
-    void construct_error( error_type && e )
+    nsel_constexpr20 void construct_error( error_type && e )
     {
-        new( &m_error ) error_type( std::move( e ) );
+        error_storage<E>::construct( &m_error, std::move( e ) );
+    }
+
+    // move the error rather than its box, so that a moved-from boxed error remains valid:
+
+    nsel_constexpr20 void move_construct_error( storage_t_impl & other )
+    {
+        error_storage<E>::construct( &m_error, std::move( error_storage<E>::get( other.m_error ) ) );
+    }
+
+    // hand over the error as stored, taking a boxed error's box without allocating:
+
+    nsel_constexpr14 stored_error_type & stored_error()
+    {
+        return m_error;
+    }
+
+    nsel_constexpr20 void construct_stored_error( stored_error_type && e )
+    {
+        detail::construct_at( &m_error, std::move( e ) );
     }
 
     template< class... Args >
-    void emplace_error( Args&&... args )
+    nsel_constexpr20 void emplace_error( Args&&... args )
     {
-        new( &m_error ) error_type( std::forward<Args>(args)...);
+        error_storage<E>::construct( &m_error, std::forward<Args>(args)...);
     }
 
     template< class U, class... Args >
-    void emplace_error( std::initializer_list<U> il, Args&&... args )
+    nsel_constexpr20 void emplace_error( std::initializer_list<U> il, Args&&... args )
     {
-        new( &m_error ) error_type( il, std::forward<Args>(args)... );
+        error_storage<E>::construct( &m_error, il, std::forward<Args>(args)... );
     }
 
-    void destruct_error()
+    nsel_constexpr20 void destruct_error()
     {
-        m_error.~error_type();
+        m_error.~stored_error_type();
     }
 
     constexpr value_type const & value() const &
@@ -529,7 +905,7 @@ public:
         return m_value;
     }
 
-    value_type & value() &
+    nsel_constexpr14 value_type & value() &
     {
         return m_value;
     }
@@ -544,42 +920,42 @@ public:
         return std::move( m_value );
     }
 
-    value_type const * value_ptr() const
+    constexpr value_type const * value_ptr() const
     {
         return &m_value;
     }
 
-    value_type * value_ptr()
+    nsel_constexpr14 value_type * value_ptr()
     {
         return &m_value;
     }
 
-    error_type const & error() const &
+    constexpr error_type const & error() const &
     {
-        return m_error;
+        return error_storage<E>::get( m_error );
     }
 
-    error_type & error() &
+    nsel_constexpr14 error_type & error() &
     {
-        return m_error;
+        return error_storage<E>::get( m_error );
     }
 
     constexpr error_type const && error() const &&
     {
-        return std::move( m_error );
+        return std::move( error_storage<E>::get( m_error ) );
     }
 
     nsel_constexpr14 error_type && error() &&
     {
-        return std::move( m_error );
+        return std::move( error_storage<E>::get( m_error ) );
     }
 
-    bool has_value() const
+    constexpr bool has_value() const
     {
         return m_has_value;
     }
 
-    void set_has_value( bool v )
+    nsel_constexpr14 void set_has_value( bool v )
     {
         m_has_value = v;
     }
@@ -588,7 +964,7 @@ private:
     union
     {
         value_type m_value;
-        error_type m_error;
+        stored_error_type m_error;
     };
 
     bool m_has_value = false;
@@ -604,68 +980,97 @@ struct storage_t_impl<void, E>
 public:
     using value_type = void;
     using error_type = E;
+    using stored_error_type = typename error_storage<E>::type;
 
     // no-op construction
-    storage_t_impl() {}
-    ~storage_t_impl() {}
+    nsel_constexpr20 storage_t_impl() {}
+    nsel_constexpr20 ~storage_t_impl() {}
+
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    ~storage_t_impl() requires detail::trivially<void, E>::destructible = default;
+
+    storage_t_impl( storage_t_impl const & ) = default;
+    storage_t_impl( storage_t_impl && ) = default;
+    storage_t_impl & operator=( storage_t_impl const & ) = default;
+    storage_t_impl & operator=( storage_t_impl && ) = default;
+#endif
 
-    explicit storage_t_impl( bool has_value )
+    nsel_constexpr20 explicit storage_t_impl( bool has_value )
         : m_has_value( has_value )
     {}
 
-    void construct_error( error_type const & e )
+    nsel_constexpr20 void construct_error( error_type const & e )
+    {
+        error_storage<E>::construct( &m_error, e );
+    }
+
+    nsel_constexpr20 void construct_error( error_type && e )
+    {
+        error_storage<E>::construct( &m_error, std::move( e ) );
+    }
+
+    // move the error rather than its box, so that a moved-from boxed error remains valid:
+
+    nsel_constexpr20 void move_construct_error( storage_t_impl & other )
+    {
+        error_storage<E>::construct( &m_error, std::move( error_storage<E>::get( other.m_error ) ) );
+    }
+
+    // hand over the error as stored, taking a boxed error's box without allocating:
+
+    nsel_constexpr14 stored_error_type & stored_error()
     {
-        new( &m_error ) error_type( e );
+        return m_error;
     }
 
-    void construct_error( error_type && e )
+    nsel_constexpr20 void construct_stored_error( stored_error_type && e )
     {
-        new( &m_error ) error_type( std::move( e ) );
+        detail::construct_at( &m_error, std::move( e ) );
     }
 
     template< class... Args >
-    void emplace_error( Args&&... args )
+    nsel_constexpr20 void emplace_error( Args&&... args )
     {
-        new( &m_error ) error_type( std::forward<Args>(args)...);
+        error_storage<E>::construct( &m_error, std::forward<Args>(args)...);
     }
 
     template< class U, class... Args >
-    void emplace_error( std::initializer_list<U> il, Args&&... args )
+    nsel_constexpr20 void emplace_error( std::initializer_list<U> il, Args&&... args )
     {
-        new( &m_error ) error_type( il, std::forward<Args>(args)... );
+        error_storage<E>::construct( &m_error, il, std::forward<Args>(args)... );
     }
 
-    void destruct_error()
+    nsel_constexpr20 void destruct_error()
     {
-        m_error.~error_type();
+        m_error.~stored_error_type();
     }
 
-    error_type const & error() const &
+    constexpr error_type const & error() const &
     {
-        return m_error;
+        return error_storage<E>::get( m_error );
     }
 
-    error_type & error() &
+    nsel_constexpr14 error_type & error() &
     {
-        return m_error;
+        return error_storage<E>::get( m_error );
     }
 
     constexpr error_type const && error() const &&
     {
-        return std::move( m_error );
+        return std::move( error_storage<E>::get( m_error ) );
     }
 
     nsel_constexpr14 error_type && error() &&
     {
-        return std::move( m_error );
+        return std::move( error_storage<E>::get( m_error ) );
     }
 
-    bool has_value() const
+    constexpr bool has_value() const
     {
         return m_has_value;
     }
 
-    void set_has_value( bool v )
+    nsel_constexpr14 void set_has_value( bool v )
     {
         m_has_value = v;
     }
@@ -674,7 +1079,7 @@ private:
     union
     {
         char m_dummy;
-        error_type m_error;
+        stored_error_type m_error;
     };
 
     bool m_has_value = false;
@@ -702,23 +1107,30 @@ public:
     storage_t() = default;
     ~storage_t() = default;
 
-    explicit storage_t( bool has_value )
+    nsel_constexpr20 explicit storage_t( bool has_value )
         : storage_t_impl<T, E>( has_value )
     {}
 
-    storage_t( storage_t const & other )
+    nsel_constexpr20 storage_t( storage_t const & other )
         : storage_t_impl<T, E>( other.has_value() )
     {
         if ( this->has_value() ) this->construct_value( other.value() );
         else                     this->construct_error( other.error() );
     }
 
-    storage_t(storage_t && other )
+    nsel_constexpr20 storage_t( storage_t && other )
         : storage_t_impl<T, E>( other.has_value() )
     {
         if ( this->has_value() ) this->construct_value( std::move( other.value() ) );
-        else                     this->construct_error( std::move( other.error() ) );
+        else                     this->move_construct_error( other );
     }
+
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    storage_t( storage_t const & ) requires detail::trivially<T, E>::copy_constructible = default;
+    storage_t( storage_t && ) requires detail::trivially<T, E>::move_constructible = default;
+    storage_t & operator=( storage_t const & ) requires detail::trivially<T, E>::copy_assignable = default;
+    storage_t & operator=( storage_t && ) requires detail::trivially<T, E>::move_assignable = default;
+#endif
 };
 
 template< typename E >
@@ -728,23 +1140,30 @@ public:
     storage_t() = default;
     ~storage_t() = default;
 
-    explicit storage_t( bool has_value )
+    nsel_constexpr20 explicit storage_t( bool has_value )
         : storage_t_impl<void, E>( has_value )
     {}
 
-    storage_t( storage_t const & other )
+    nsel_constexpr20 storage_t( storage_t const & other )
         : storage_t_impl<void, E>( other.has_value() )
     {
         if ( this->has_value() ) ;
         else                     this->construct_error( other.error() );
     }
 
-    storage_t(storage_t && other )
+    nsel_constexpr20 storage_t( storage_t && other )
         : storage_t_impl<void, E>( other.has_value() )
     {
         if ( this->has_value() ) ;
-        else                     this->construct_error( std::move( other.error() ) );
+        else                     this->move_construct_error( other );
     }
+
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    storage_t( storage_t const & ) requires detail::trivially<void, E>::copy_constructible = default;
+    storage_t( storage_t && ) requires detail::trivially<void, E>::move_constructible = default;
+    storage_t & operator=( storage_t const & ) requires detail::trivially<void, E>::copy_assignable = default;
+    storage_t & operator=( storage_t && ) requires detail::trivially<void, E>::move_assignable = default;
+#endif
 };
 
 template< typename T, typename E >
@@ -754,11 +1173,11 @@ public:
     storage_t() = default;
     ~storage_t() = default;
 
-    explicit storage_t( bool has_value )
+    nsel_constexpr20 explicit storage_t( bool has_value )
         : storage_t_impl<T, E>( has_value )
     {}
 
-    storage_t( storage_t const & other )
+    nsel_constexpr20 storage_t( storage_t const & other )
         : storage_t_impl<T, E>(other.has_value())
     {
         if ( this->has_value() ) this->construct_value( other.value() );
@@ -766,6 +1185,11 @@ public:
     }
 
     storage_t( storage_t && other ) = delete;
+
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    storage_t( storage_t const & ) requires detail::trivially<T, E>::copy_constructible = default;
+    storage_t & operator=( storage_t const & ) requires detail::trivially<T, E>::copy_assignable = default;
+#endif
 };
 
 template< typename E >
@@ -775,11 +1199,11 @@ public:
     storage_t() = default;
     ~storage_t() = default;
 
-    explicit storage_t( bool has_value )
+    nsel_constexpr20 explicit storage_t( bool has_value )
         : storage_t_impl<void, E>( has_value )
     {}
 
-    storage_t( storage_t const & other )
+    nsel_constexpr20 storage_t( storage_t const & other )
         : storage_t_impl<void, E>(other.has_value())
     {
         if ( this->has_value() ) ;
@@ -787,6 +1211,11 @@ public:
     }
 
     storage_t( storage_t && other ) = delete;
+
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    storage_t( storage_t const & ) requires detail::trivially<void, E>::copy_constructible = default;
+    storage_t & operator=( storage_t const & ) requires detail::trivially<void, E>::copy_assignable = default;
+#endif
 };
 
 template< typename T, typename E >
@@ -796,18 +1225,23 @@ public:
     storage_t() = default;
     ~storage_t() = default;
 
-    explicit storage_t( bool has_value )
+    nsel_constexpr20 explicit storage_t( bool has_value )
         : storage_t_impl<T, E>( has_value )
     {}
 
     storage_t( storage_t const & other ) = delete;
 
-    storage_t( storage_t && other )
+    nsel_constexpr20 storage_t( storage_t && other )
         : storage_t_impl<T, E>( other.has_value() )
     {
         if ( this->has_value() ) this->construct_value( std::move( other.value() ) );
-        else                     this->construct_error( std::move( other.error() ) );
+        else                     this->move_construct_error( other );
     }
+
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    storage_t( storage_t && ) requires detail::trivially<T, E>::move_constructible = default;
+    storage_t & operator=( storage_t && ) requires detail::trivially<T, E>::move_assignable = default;
+#endif
 };
 
 template< typename E >
@@ -817,25 +1251,30 @@ public:
     storage_t() = default;
     ~storage_t() = default;
 
-    explicit storage_t( bool has_value )
+    nsel_constexpr20 explicit storage_t( bool has_value )
         : storage_t_impl<void, E>( has_value )
     {}
 
     storage_t( storage_t const & other ) = delete;
 
-    storage_t( storage_t && other )
+    nsel_constexpr20 storage_t( storage_t && other )
         : storage_t_impl<void, E>( other.has_value() )
     {
         if ( this->has_value() ) ;
-        else                     this->construct_error( std::move( other.error() ) );
+        else                     this->move_construct_error( other );
     }
+
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    storage_t( storage_t && ) requires detail::trivially<void, E>::move_constructible = default;
+    storage_t & operator=( storage_t && ) requires detail::trivially<void, E>::move_assignable = default;
+#endif
 };
 
 } // namespace detail
 
 /// x.x.5 Unexpected object type; unexpected_type; C++17 and later can also use aliased type unexpected.
 
-#if nsel_P0323R <= 2
+#if nsel_P0323R <= 2 && !defined( NONSTD_EXPECTED_FWD_LITE_HPP )
 template< typename E = std::exception_ptr >
 class unexpected_type
 #else
@@ -885,14 +1324,7 @@ public:
     template< typename E2
         nsel_REQUIRES_T(
             std::is_constructible<    E, E2>::value
-            && !std::is_constructible<E, unexpected_type<E2>       &   >::value
-            && !std::is_constructible<E, unexpected_type<E2>           >::value
-            && !std::is_constructible<E, unexpected_type<E2> const &   >::value
-            && !std::is_constructible<E, unexpected_type<E2> const     >::value
-            && !std::is_convertible<     unexpected_type<E2>       &, E>::value
-            && !std::is_convertible<     unexpected_type<E2>        , E>::value
-            && !std::is_convertible<     unexpected_type<E2> const &, E>::value
-            && !std::is_convertible<     unexpected_type<E2> const  , E>::value
+            && !detail::is_convertible_from_any<E, unexpected_type<E2> >::value
             && !std::is_convertible< E2 const &, E>::value /*=> explicit */
         )
     >
@@ -903,14 +1335,7 @@ public:
     template< typename E2
         nsel_REQUIRES_T(
             std::is_constructible<    E, E2>::value
-            && !std::is_constructible<E, unexpected_type<E2>       &   >::value
-            && !std::is_constructible<E, unexpected_type<E2>           >::value
-            && !std::is_constructible<E, unexpected_type<E2> const &   >::value
-            && !std::is_constructible<E, unexpected_type<E2> const     >::value
-            && !std::is_convertible<     unexpected_type<E2>       &, E>::value
-            && !std::is_convertible<     unexpected_type<E2>        , E>::value
-            && !std::is_convertible<     unexpected_type<E2> const &, E>::value
-            && !std::is_convertible<     unexpected_type<E2> const  , E>::value
+            && !detail::is_convertible_from_any<E, unexpected_type<E2> >::value
             &&  std::is_convertible< E2 const &, E>::value /*=> explicit */
         )
     >
@@ -921,14 +1346,7 @@ public:
     template< typename E2
         nsel_REQUIRES_T(
             std::is_constructible<    E, E2>::value
-            && !std::is_constructible<E, unexpected_type<E2>       &   >::value
-            && !std::is_constructible<E, unexpected_type<E2>           >::value
-            && !std::is_constructible<E, unexpected_type<E2> const &   >::value
-            && !std::is_constructible<E, unexpected_type<E2> const     >::value
-            && !std::is_convertible<     unexpected_type<E2>       &, E>::value
-            && !std::is_convertible<     unexpected_type<E2>        , E>::value
-            && !std::is_convertible<     unexpected_type<E2> const &, E>::value
-            && !std::is_convertible<     unexpected_type<E2> const  , E>::value
+            && !detail::is_convertible_from_any<E, unexpected_type<E2> >::value
             && !std::is_convertible< E2 const &, E>::value /*=> explicit */
         )
     >
@@ -939,14 +1357,7 @@ public:
     template< typename E2
         nsel_REQUIRES_T(
             std::is_constructible<    E, E2>::value
-            && !std::is_constructible<E, unexpected_type<E2>       &   >::value
-            && !std::is_constructible<E, unexpected_type<E2>           >::value
-            && !std::is_constructible<E, unexpected_type<E2> const &   >::value
-            && !std::is_constructible<E, unexpected_type<E2> const     >::value
-            && !std::is_convertible<     unexpected_type<E2>       &, E>::value
-            && !std::is_convertible<     unexpected_type<E2>        , E>::value
-            && !std::is_convertible<     unexpected_type<E2> const &, E>::value
-            && !std::is_convertible<     unexpected_type<E2> const  , E>::value
+            && !detail::is_convertible_from_any<E, unexpected_type<E2> >::value
             &&  std::is_convertible< E2 const &, E>::value /*=> non-explicit */
         )
     >
@@ -1001,8 +1412,9 @@ public:
 
     // x.x.5.2.4 Swap
 
-    nsel_REQUIRES_R( void,
-        std17::is_swappable<E>::value
+    template< typename U = E >
+    nsel_constexpr20 nsel_REQUIRES_R( void,
+        std17::is_swappable<U>::value
     )
     swap( unexpected_type & other ) noexcept (
         std17::is_nothrow_swappable<E>::value
@@ -1123,7 +1535,7 @@ template< typename E
         std17::is_swappable<E>::value
     )
 >
-void swap( unexpected_type<E> & x, unexpected_type<E> & y) noexcept ( noexcept ( x.swap(y) ) )
+nsel_constexpr20 void swap( unexpected_type<E> & x, unexpected_type<E> & y) noexcept ( noexcept ( x.swap(y) ) )
 {
     x.swap( y );
 }
@@ -1318,6 +1730,24 @@ struct error_traits
     }
 };
 
+#if nsel_CONFIG_EXTERN_INSTANTIATIONS
+
+// defined in library expected-lite-instantiations:
+
+template<>
+struct error_traits< std::exception_ptr >
+{
+    static void rethrow( std::exception_ptr const & e );
+};
+
+template<>
+struct error_traits< std::error_code >
+{
+    static void rethrow( std::error_code const & e );
+};
+
+#else // nsel_CONFIG_EXTERN_INSTANTIATIONS
+
 template<>
 struct error_traits< std::exception_ptr >
 {
@@ -1336,6 +1766,8 @@ struct error_traits< std::error_code >
     }
 };
 
+#endif // nsel_CONFIG_EXTERN_INSTANTIATIONS
+
 #endif // nsel_CONFIG_NO_EXCEPTIONS
 
 } // namespace expected_lite
@@ -1346,9 +1778,25 @@ using expected_lite::unexpected_type;
 
 namespace expected_lite {
 
+namespace detail {
+
+/// T is constructible from U, which is neither an expected<T,E>, an
+/// unexpected_type<E> nor an in-place tag: the common constraint of the
+/// explicit and non-explicit value constructors.
+
+template< typename T, typename E, typename U, typename V = typename std20::remove_cvref<U>::type >
+struct is_value_constructible : std::integral_constant<bool,
+    !std::is_same<expected<T, E>, V>::value
+    && !std::is_same<nonstd::unexpected_type<E>, V>::value
+    && !std::is_same<V, nonstd_lite_in_place_t(U)>::value
+    && std::is_constructible<T, U&&>::value
+>{};
+
+} // namespace detail
+
 /// class expected
 
-#if nsel_P0323R <= 2
+#if nsel_P0323R <= 2 && !defined( NONSTD_EXPECTED_FWD_LITE_HPP )
 template< typename T, typename E = std::exception_ptr >
 class expected
 #else
@@ -1388,14 +1836,7 @@ public:
         nsel_REQUIRES_T(
             std::is_constructible<    T, U const &>::value
             &&  std::is_constructible<E, G const &>::value
-            && !std::is_constructible<T, expected<U, G>       &    >::value
-            && !std::is_constructible<T, expected<U, G>       &&   >::value
-            && !std::is_constructible<T, expected<U, G> const &    >::value
-            && !std::is_constructible<T, expected<U, G> const &&   >::value
-            && !std::is_convertible<     expected<U, G>       & , T>::value
-            && !std::is_convertible<     expected<U, G>       &&, T>::value
-            && !std::is_convertible<     expected<U, G> const & , T>::value
-            && !std::is_convertible<     expected<U, G> const &&, T>::value
+            && !detail::is_convertible_from_any<T, expected<U, G> >::value
             && (!std::is_convertible<U const &, T>::value || !std::is_convertible<G const &, E>::value ) /*=> explicit */
         )
     >
@@ -1410,14 +1851,7 @@ public:
         nsel_REQUIRES_T(
             std::is_constructible<    T, U const &>::value
             &&  std::is_constructible<E, G const &>::value
-            && !std::is_constructible<T, expected<U, G>       &    >::value
-            && !std::is_constructible<T, expected<U, G>       &&   >::value
-            && !std::is_constructible<T, expected<U, G> const &    >::value
-            && !std::is_constructible<T, expected<U, G> const &&   >::value
-            && !std::is_convertible<     expected<U, G>       & , T>::value
-            && !std::is_convertible<     expected<U, G>       &&, T>::value
-            && !std::is_convertible<     expected<U, G> const  &, T>::value
-            && !std::is_convertible<     expected<U, G> const &&, T>::value
+            && !detail::is_convertible_from_any<T, expected<U, G> >::value
             && !(!std::is_convertible<U const &, T>::value || !std::is_convertible<G const &, E>::value ) /*=> non-explicit */
         )
     >
@@ -1432,14 +1866,7 @@ public:
         nsel_REQUIRES_T(
             std::is_constructible<    T, U>::value
             &&  std::is_constructible<E, G>::value
-            && !std::is_constructible<T, expected<U, G>       &    >::value
-            && !std::is_constructible<T, expected<U, G>       &&   >::value
-            && !std::is_constructible<T, expected<U, G> const &    >::value
-            && !std::is_constructible<T, expected<U, G> const &&   >::value
-            && !std::is_convertible<     expected<U, G>       & , T>::value
-            && !std::is_convertible<     expected<U, G>       &&, T>::value
-            && !std::is_convertible<     expected<U, G> const & , T>::value
-            && !std::is_convertible<     expected<U, G> const &&, T>::value
+            && !detail::is_convertible_from_any<T, expected<U, G> >::value
             && (!std::is_convertible<U, T>::value || !std::is_convertible<G, E>::value ) /*=> explicit */
         )
     >
@@ -1454,14 +1881,7 @@ public:
         nsel_REQUIRES_T(
             std::is_constructible<    T, U>::value
             &&  std::is_constructible<E, G>::value
-            && !std::is_constructible<T, expected<U, G>      &     >::value
-            && !std::is_constructible<T, expected<U, G>      &&    >::value
-            && !std::is_constructible<T, expected<U, G> const &    >::value
-            && !std::is_constructible<T, expected<U, G> const &&   >::value
-            && !std::is_convertible<     expected<U, G>       & , T>::value
-            && !std::is_convertible<     expected<U, G>       &&, T>::value
-            && !std::is_convertible<     expected<U, G> const & , T>::value
-            && !std::is_convertible<     expected<U, G> const &&, T>::value
+            && !detail::is_convertible_from_any<T, expected<U, G> >::value
             && !(!std::is_convertible<U, T>::value || !std::is_convertible<G, E>::value ) /*=> non-explicit */
         )
     >
@@ -1485,10 +1905,7 @@ public:
 
     template< typename U = T
         nsel_REQUIRES_T(
-            std::is_constructible<T,U&&>::value
-            && !std::is_same<typename std20::remove_cvref<U>::type, nonstd_lite_in_place_t(U)>::value
-            && !std::is_same<        expected<T,E>     , typename std20::remove_cvref<U>::type>::value
-            && !std::is_same<nonstd::unexpected_type<E>, typename std20::remove_cvref<U>::type>::value
+            detail::is_value_constructible<T, E, U>::value
             && !std::is_convertible<U&&,T>::value /*=> explicit */
         )
     >
@@ -1504,10 +1921,7 @@ public:
 
     template< typename U = T
         nsel_REQUIRES_T(
-            std::is_constructible<T,U&&>::value
-            && !std::is_same<typename std20::remove_cvref<U>::type, nonstd_lite_in_place_t(U)>::value
-            && !std::is_same<        expected<T,E>     , typename std20::remove_cvref<U>::type>::value
-            && !std::is_same<nonstd::unexpected_type<E>, typename std20::remove_cvref<U>::type>::value
+            detail::is_value_constructible<T, E, U>::value
             &&  std::is_convertible<U&&,T>::value /*=> non-explicit */
         )
     >
@@ -1621,11 +2035,14 @@ public:
 
     // x.x.4.2 destructor
 
-    // TODO: ~expected: triviality
     // Effects: If T is not cv void and is_trivially_destructible_v<T> is false and bool(*this), calls val.~T(). If is_trivially_destructible_v<E> is false and !bool(*this), calls unexpect.~unexpected<E>().
     // Remarks: If either T is cv void or is_trivially_destructible_v<T> is true, and is_trivially_destructible_v<E> is true, then this destructor shall be a trivial destructor.
 
-    ~expected()
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    ~expected() requires detail::trivially<T, E>::destructible = default;
+#endif
+
+    nsel_constexpr20 ~expected()
     {
         if ( has_value() ) contained.destruct_value();
         else               contained.destruct_error();
@@ -1633,18 +2050,23 @@ public:
 
     // x.x.4.3 assignment
 
-    expected & operator=( expected const & other )
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    expected & operator=( expected const & ) requires detail::trivially<T, E>::copy_assignable = default;
+    expected & operator=( expected && ) requires detail::trivially<T, E>::move_assignable = default;
+#endif
+
+    nsel_constexpr20 expected & operator=( expected const & other )
     {
         expected( other ).swap( *this );
         return *this;
     }
 
-    expected & operator=( expected && other ) noexcept
+    nsel_constexpr20 expected & operator=( expected && other ) noexcept
     (
         std::is_nothrow_move_constructible<   T>::value
         && std::is_nothrow_move_assignable<   T>::value
-        && std::is_nothrow_move_constructible<E>::value     // added for missing
-        && std::is_nothrow_move_assignable<   E>::value )   //   nothrow above
+        && detail::is_nothrow_error_move_constructible<E>::value    // added for missing
+        && std::is_nothrow_move_assignable<   E>::value )               //   nothrow above
     {
         expected( std::move( other ) ).swap( *this );
         return *this;
@@ -1652,13 +2074,15 @@ public:
 
     template< typename U
         nsel_REQUIRES_T(
-            !std::is_same<expected<T,E>, typename std20::remove_cvref<U>::type>::value
-            && std17::conjunction<std::is_scalar<T>, std::is_same<T, std::decay<U>> >::value
-            && std::is_constructible<T ,U>::value
-            && std::is_assignable<   T&,U>::value
-            && std::is_nothrow_move_constructible<E>::value )
+            std17::conjunction<
+                std17::negation< std::is_same<expected<T,E>, typename std20::remove_cvref<U>::type> >
+                , std::is_scalar<T>
+                , std::is_same<T, std::decay<U>>
+                , std::is_constructible<T ,U>
+                , std::is_assignable<   T&,U>
+                , std::is_nothrow_move_constructible<E> >::value )
     >
-    expected & operator=( U && value )
+    nsel_constexpr20 expected & operator=( U && value )
     {
         expected( std::forward<U>( value ) ).swap( *this );
         return *this;
@@ -1670,7 +2094,7 @@ public:
             && std::is_copy_assignable<E>::value
         )
     >
-    expected & operator=( nonstd::unexpected_type<G> const & error )
+    nsel_constexpr20 expected & operator=( nonstd::unexpected_type<G> const & error )
     {
         expected( unexpect, error.value() ).swap( *this );
         return *this;
@@ -1682,7 +2106,7 @@ public:
             && std::is_move_assignable<E>::value
         )
     >
-    expected & operator=( nonstd::unexpected_type<G> && error )
+    nsel_constexpr20 expected & operator=( nonstd::unexpected_type<G> && error )
     {
         expected( unexpect, std::move( error.value() ) ).swap( *this );
         return *this;
@@ -1693,7 +2117,7 @@ public:
             std::is_nothrow_constructible<T, Args&&...>::value
         )
     >
-    value_type & emplace( Args &&... args )
+    nsel_constexpr20 value_type & emplace( Args &&... args )
     {
         expected( nonstd_lite_in_place(T), std::forward<Args>(args)... ).swap( *this );
         return value();
@@ -1704,7 +2128,7 @@ public:
             std::is_nothrow_constructible<T, std::initializer_list<U>&, Args&&...>::value
         )
     >
-    value_type & emplace( std::initializer_list<U> il, Args &&... args )
+    nsel_constexpr20 value_type & emplace( std::initializer_list<U> il, Args &&... args )
     {
         expected( nonstd_lite_in_place(T), il, std::forward<Args>(args)... ).swap( *this );
         return value();
@@ -1713,7 +2137,7 @@ public:
     // x.x.4.4 swap
 
     template< typename U=T, typename G=E >
-    nsel_REQUIRES_R( void,
+    nsel_constexpr20 nsel_REQUIRES_R( void,
         std17::is_swappable<   U>::value
         && std17::is_swappable<G>::value
         && ( std::is_move_constructible<U>::value || std::is_move_constructible<G>::value )
@@ -1728,11 +2152,11 @@ public:
 
         if      (   bool(*this) &&   bool(other) ) { swap( contained.value(), other.contained.value() ); }
         else if ( ! bool(*this) && ! bool(other) ) { swap( contained.error(), other.contained.error() ); }
-        else if (   bool(*this) && ! bool(other) ) { error_type t( std::move( other.error() ) );
+        else if (   bool(*this) && ! bool(other) ) { typename detail::error_storage<E>::type t( std::move( other.contained.stored_error() ) );
                                                      other.contained.destruct_error();
                                                      other.contained.construct_value( std::move( contained.value() ) );
                                                      contained.destruct_value();
-                                                     contained.construct_error( std::move( t ) );
+                                                     contained.construct_stored_error( std::move( t ) );
                                                      bool has_value = contained.has_value();
                                                      bool other_has_value = other.has_value();
                                                      other.contained.set_has_value(has_value);
@@ -1748,7 +2172,7 @@ public:
         return assert( has_value() ), contained.value_ptr();
     }
 
-    value_type * operator ->()
+    nsel_constexpr14 value_type * operator ->()
     {
         return assert( has_value() ), contained.value_ptr();
     }
@@ -1758,7 +2182,7 @@ public:
         return assert( has_value() ), contained.value();
     }
 
-    value_type & operator *() &
+    nsel_constexpr14 value_type & operator *() &
     {
         return assert( has_value() ), contained.value();
     }
@@ -1794,7 +2218,7 @@ public:
             : ( error_traits<error_type>::rethrow( contained.error() ), contained.value() );
     }
 
-    value_type & value() &
+    nsel_constexpr14 value_type & value() &
     {
         return has_value()
             ? ( contained.value() )
@@ -1824,7 +2248,7 @@ public:
         return assert( ! has_value() ), contained.error();
     }
 
-    error_type & error() &
+    nsel_constexpr14 error_type & error() &
     {
         return assert( ! has_value() ), contained.error();
     }
@@ -1836,7 +2260,7 @@ public:
         return assert( ! has_value() ), std::move( contained.error() );
     }
 
-    error_type && error() &&
+    nsel_constexpr14 error_type && error() &&
     {
         return assert( ! has_value() ), std::move( contained.error() );
     }
@@ -1849,7 +2273,7 @@ public:
     }
 
     template< typename Ex >
-    bool has_exception() const
+    constexpr bool has_exception() const
     {
         using ContainedEx = typename std::remove_reference< decltype( get_unexpected().value() ) >::type;
         return ! has_value() && std::is_base_of< Ex, ContainedEx>::value;
@@ -1861,7 +2285,7 @@ public:
             && std::is_convertible<U&&, T>::value
         )
     >
-    value_type value_or( U && v ) const &
+    nsel_constexpr14 value_type value_or( U && v ) const &
     {
         return has_value()
             ? contained.value()
@@ -1874,7 +2298,7 @@ public:
             && std::is_convertible<U&&, T>::value
         )
     >
-    value_type value_or( U && v ) &&
+    nsel_constexpr14 value_type value_or( U && v ) &&
     {
         return has_value()
             ? std::move( contained.value() )
@@ -2017,7 +2441,11 @@ public:
 
     // destructor
 
-    ~expected()
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    ~expected() requires detail::trivially<void, E>::destructible = default;
+#endif
+
+    nsel_constexpr20 ~expected()
     {
         if ( ! has_value() )
         {
@@ -2027,22 +2455,27 @@ public:
 
     // x.x.4.3 assignment
 
-    expected & operator=( expected const & other )
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    expected & operator=( expected const & ) requires detail::trivially<void, E>::copy_assignable = default;
+    expected & operator=( expected && ) requires detail::trivially<void, E>::move_assignable = default;
+#endif
+
+    nsel_constexpr20 expected & operator=( expected const & other )
     {
         expected( other ).swap( *this );
         return *this;
     }
 
-    expected & operator=( expected && other ) noexcept
+    nsel_constexpr20 expected & operator=( expected && other ) noexcept
     (
         std::is_nothrow_move_assignable<E>::value &&
-        std::is_nothrow_move_constructible<E>::value )
+        detail::is_nothrow_error_move_constructible<E>::value )
     {
         expected( std::move( other ) ).swap( *this );
         return *this;
     }
 
-    void emplace()
+    nsel_constexpr20 void emplace()
     {
         expected().swap( *this );
     }
@@ -2050,7 +2483,7 @@ public:
     // x.x.4.4 swap
 
     template< typename G = E >
-    nsel_REQUIRES_R( void,
+    nsel_constexpr20 nsel_REQUIRES_R( void,
         std17::is_swappable<G>::value
         && std::is_move_constructible<G>::value
     )
@@ -2062,7 +2495,8 @@ public:
         using std::swap;
 
         if      ( ! bool(*this) && ! bool(other) ) { swap( contained.error(), other.contained.error() ); }
-        else if (   bool(*this) && ! bool(other) ) { contained.construct_error( std::move( other.error() ) );
+        else if (   bool(*this) && ! bool(other) ) { contained.construct_stored_error( std::move( other.contained.stored_error() ) );
+                                                     other.contained.destruct_error();
                                                      bool has_value = contained.has_value();
                                                      bool other_has_value = other.has_value();
                                                      other.contained.set_has_value(has_value);
@@ -2083,7 +2517,7 @@ public:
         return contained.has_value();
     }
 
-    void value() const
+    nsel_constexpr14 void value() const
     {
         if ( ! has_value() )
         {
@@ -2096,7 +2530,7 @@ public:
         return assert( ! has_value() ), contained.error();
     }
 
-    error_type & error() &
+    nsel_constexpr14 error_type & error() &
     {
         return assert( ! has_value() ), contained.error();
     }
@@ -2108,7 +2542,7 @@ public:
         return assert( ! has_value() ), std::move( contained.error() );
     }
 
-    error_type && error() &&
+    nsel_constexpr14 error_type && error() &&
     {
         return assert( ! has_value() ), std::move( contained.error() );
     }
@@ -2121,7 +2555,7 @@ public:
     }
 
     template< typename Ex >
-    bool has_exception() const
+    constexpr bool has_exception() const
     {
         using ContainedEx = typename std::remove_reference< decltype( get_unexpected().value() ) >::type;
         return ! has_value() && std::is_base_of< Ex, ContainedEx>::value;
@@ -2372,7 +2806,7 @@ template< typename T, typename E
         && std17::is_swappable<T>::value
         && std17::is_swappable<E>::value )
 >
-void swap( expected<T,E> & x, expected<T,E> & y ) noexcept ( noexcept ( x.swap(y) ) )
+nsel_constexpr20 void swap( expected<T,E> & x, expected<T,E> & y ) noexcept ( noexcept ( x.swap(y) ) )
 {
     x.swap( y );
 }
@@ -2445,6 +2879,18 @@ auto make_expected_from_call( F f ) -> expected<void>
 
 #endif // nsel_P0323R
 
+/// common specializations, instantiated in library expected-lite-instantiations:
+
+#if nsel_CONFIG_EXTERN_INSTANTIATIONS
+
+extern template class unexpected_type< std::error_code >;
+
+extern template class expected< void,        std::error_code >;
+extern template class expected< int,         std::error_code >;
+extern template class expected< std::string, std::error_code >;
+
+#endif // nsel_CONFIG_EXTERN_INSTANTIATIONS
+
 } // namespace expected_lite
 
 using namespace expected_lite;
@@ -0,0 +1,358 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_algorithm: algorithms over ranges and packs of expected<T,E>.
+
+#ifndef NONSTD_EXPECTED_ALGORITHM_LITE_HPP
+#define NONSTD_EXPECTED_ALGORITHM_LITE_HPP
+
+#include "expected.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nonstd { namespace expected_lite {
+
+namespace detail {
+
+/// element, value and error type of a range of expected.
+
+template< typename Range >
+struct range_expected
+{
+    using iterator   = decltype( std::begin( std::declval<Range &>() ) );
+    using element    = typename std::decay< decltype( *std::declval<iterator>() ) >::type;
+    using value_type = typename element::value_type;
+    using error_type = typename element::error_type;
+};
+
+/// element of a range, as rvalue if the range is an rvalue, to move from it.
+
+template< typename Range, typename X >
+auto forward_element( X & x ) noexcept
+    -> typename std::conditional< std::is_lvalue_reference<Range>::value, X &, X && >::type
+{
+    return static_cast< typename std::conditional< std::is_lvalue_reference<Range>::value, X &, X && >::type >( x );
+}
+
+/// number of elements if known without traversal, 0 otherwise.
+
+template< typename It >
+std::size_t size_hint( It first, It last, std::random_access_iterator_tag )
+{
+    return last < first ? 0 : static_cast<std::size_t>( last - first );
+}
+
+template< typename It >
+std::size_t size_hint( It, It, std::input_iterator_tag )
+{
+    return 0;
+}
+
+template< typename It >
+std::size_t size_hint( It first, It last )
+{
+    return size_hint( first, last, typename std::iterator_traits<It>::iterator_category() );
+}
+
+template< typename C, typename = void >
+struct has_reserve : std::false_type {};
+
+template< typename C >
+struct has_reserve< C, decltype( std::declval<C &>().reserve( std::size_t() ), void() ) > : std::true_type {};
+
+template< typename C >
+void reserve_more( C & c, std::size_t n, std::true_type )
+{
+    if ( n != 0 )
+        c.reserve( c.size() + n );
+}
+
+template< typename C >
+void reserve_more( C &, std::size_t, std::false_type ) {}
+
+template< typename C >
+void reserve_more( C & c, std::size_t n )
+{
+    reserve_more( c, n, has_reserve<C>() );
+}
+
+/// number of values in [first, last), if the range can be traversed twice.
+
+template< typename It >
+bool count_values( It first, It last, std::size_t & values, std::size_t & errors, std::forward_iterator_tag )
+{
+    for ( ; first != last; ++first )
+    {
+        if ( (*first).has_value() ) ++values;
+        else                        ++errors;
+    }
+    return true;
+}
+
+template< typename It >
+bool count_values( It, It, std::size_t &, std::size_t &, std::input_iterator_tag )
+{
+    return false;
+}
+
+/// value and error type of an expected argument.
+
+template< typename X >
+using value_type_of = typename std::decay<X>::type::value_type;
+
+template< typename X >
+using error_type_of = typename std::decay<X>::type::error_type;
+
+template< typename E, typename... Xs >
+struct same_error_types : std::true_type {};
+
+template< typename E, typename X, typename... Xs >
+struct same_error_types< E, X, Xs... > : std::integral_constant< bool,
+    std::is_same< E, error_type_of<X> >::value && same_error_types< E, Xs... >::value > {};
+
+/// conjunction of has_value() of all arguments without short-circuit branches.
+
+inline constexpr bool all_values() noexcept
+{
+    return true;
+}
+
+template< typename... Bs >
+constexpr bool all_values( bool b, Bs... bs ) noexcept
+{
+    return b & all_values( bs... );
+}
+
+/// error of the first argument that has no value; one of them must have none.
+
+template< typename E, typename X >
+E first_error_of( X && x )
+{
+    return std::forward<X>( x ).error();
+}
+
+template< typename E, typename X, typename Y, typename... Xs >
+E first_error_of( X && x, Y && y, Xs &&... xs )
+{
+    if ( ! x.has_value() )
+        return std::forward<X>( x ).error();
+
+    return first_error_of<E>( std::forward<Y>( y ), std::forward<Xs>( xs )... );
+}
+
+template< typename R, typename E, typename F, typename... Xs >
+auto zip_with( std::false_type /*void*/, F && f, Xs &&... xs ) -> expected< R, E >
+{
+    return expected< R, E >( nonstd_lite_in_place( R ), std::forward<F>( f )( *std::forward<Xs>( xs )... ) );
+}
+
+template< typename R, typename E, typename F, typename... Xs >
+auto zip_with( std::true_type /*void*/, F && f, Xs &&... xs ) -> expected< void, E >
+{
+    std::forward<F>( f )( *std::forward<Xs>( xs )... );
+    return expected< void, E >();
+}
+
+} // namespace detail
+
+/// append the values of range r to container c, up to the first error;
+/// return that error, or success if there is none.
+/// Reserves room if the size of r is known and moves from an rvalue range.
+
+template< typename Container, typename Range
+    , typename E = typename detail::range_expected<Range>::error_type
+>
+expected<void, E> collect_into( Container & c, Range && r )
+{
+    auto first = std::begin( r );
+    auto last  = std::end( r );
+
+    detail::reserve_more( c, detail::size_hint( first, last ) );
+
+    for ( ; first != last; ++first )
+    {
+        auto && e = *first;
+
+        if ( ! e.has_value() )
+            return make_unexpected( detail::forward_element<Range>( e ).error() );
+
+        c.insert( c.end(), *detail::forward_element<Range>( e ) );
+    }
+    return expected<void, E>();
+}
+
+/// the values of range r in a std::vector, or the first error.
+
+template< typename Range
+    , typename T = typename detail::range_expected<Range>::value_type
+    , typename E = typename detail::range_expected<Range>::error_type
+>
+auto collect( Range && r )
+    -> typename std::enable_if< ! std::is_void<T>::value, expected< std::vector<T>, E > >::type
+{
+    std::vector<T> values;
+
+    auto result = collect_into( values, std::forward<Range>( r ) );
+
+    if ( ! result.has_value() )
+        return make_unexpected( std::move( result ).error() );
+
+    return expected< std::vector<T>, E >( std::move( values ) );
+}
+
+/// success if range r of expected<void,E> holds no error, or the first error.
+
+template< typename Range
+    , typename T = typename detail::range_expected<Range>::value_type
+    , typename E = typename detail::range_expected<Range>::error_type
+>
+auto collect( Range && r )
+    -> typename std::enable_if< std::is_void<T>::value, expected<void, E> >::type
+{
+    for ( auto first = std::begin( r ), last = std::end( r ); first != last; ++first )
+    {
+        auto && e = *first;
+
+        if ( ! e.has_value() )
+            return make_unexpected( detail::forward_element<Range>( e ).error() );
+    }
+    return expected<void, E>();
+}
+
+/// output positions after partition_results().
+
+template< typename ValueOut, typename ErrorOut >
+struct partition_result
+{
+    ValueOut values;
+    ErrorOut errors;
+};
+
+/// how partition_results() sizes its output vectors in advance.
+
+enum class partition_reserve
+{
+    none,       // grow as needed
+    size,       // reserve room for all elements as values
+    count       // count values and errors first, then reserve exactly
+};
+
+/// in a single pass, write the values of range r to values and each error,
+/// with its index in r, as std::pair<std::size_t,E> to errors.
+/// Moves from the elements of an rvalue range.
+
+template< typename Range, typename ValueOut, typename ErrorOut
+    , typename E = typename detail::range_expected<Range>::error_type
+>
+partition_result<ValueOut, ErrorOut> partition_results( Range && r, ValueOut values, ErrorOut errors )
+{
+    std::size_t index = 0;
+
+    for ( auto first = std::begin( r ), last = std::end( r ); first != last; ++first, ++index )
+    {
+        auto && e = *first;
+
+        if ( e.has_value() )
+        {
+            *values = *detail::forward_element<Range>( e );
+            ++values;
+        }
+        else
+        {
+            *errors = std::pair<std::size_t, E>( index, detail::forward_element<Range>( e ).error() );
+            ++errors;
+        }
+    }
+    return partition_result<ValueOut, ErrorOut>{ values, errors };
+}
+
+/// append the values of range r to values and its indexed errors to errors,
+/// reserving room as specified by how.
+
+template< typename Range, typename T, typename VA, typename E, typename EA >
+void partition_results( Range && r
+    , std::vector<T, VA> & values
+    , std::vector<std::pair<std::size_t, E>, EA> & errors
+    , partition_reserve how = partition_reserve::count )
+{
+    auto first = std::begin( r );
+    auto last  = std::end( r );
+
+    using category = typename std::iterator_traits< decltype( first ) >::iterator_category;
+
+    std::size_t nvalues = 0;
+    std::size_t nerrors = 0;
+
+    if ( how == partition_reserve::count && detail::count_values( first, last, nvalues, nerrors, category() ) )
+    {
+        detail::reserve_more( values, nvalues );
+        detail::reserve_more( errors, nerrors );
+    }
+    else if ( how != partition_reserve::none )
+    {
+        detail::reserve_more( values, detail::size_hint( first, last ) );
+    }
+
+    partition_results( std::forward<Range>( r ), std::back_inserter( values ), std::back_inserter( errors ) );
+}
+
+/// the values of all arguments in a tuple, or the error of the first one that
+/// has none. Checks the arguments with a single fold over their has_value()
+/// and moves from rvalue arguments. All error types must be the same.
+
+template< typename X, typename... Xs
+    , typename E = detail::error_type_of<X>
+>
+auto zip( X && x, Xs &&... xs )
+    -> expected< std::tuple< detail::value_type_of<X>, detail::value_type_of<Xs>... >, E >
+{
+    static_assert( detail::same_error_types< E, Xs... >::value, "zip(): all error types must be the same" );
+
+    using result = expected< std::tuple< detail::value_type_of<X>, detail::value_type_of<Xs>... >, E >;
+
+    if ( ! detail::all_values( x.has_value(), xs.has_value()... ) )
+        return make_unexpected( detail::first_error_of<E>( std::forward<X>( x ), std::forward<Xs>( xs )... ) );
+
+    return result( nonstd_lite_in_place( typename result::value_type ), *std::forward<X>( x ), *std::forward<Xs>( xs )... );
+}
+
+/// same as zip().
+
+template< typename X, typename... Xs >
+auto when_all( X && x, Xs &&... xs )
+    -> decltype( zip( std::forward<X>( x ), std::forward<Xs>( xs )... ) )
+{
+    return zip( std::forward<X>( x ), std::forward<Xs>( xs )... );
+}
+
+/// f applied to the values of all arguments, or the error of the first one
+/// that has none. Passes the values directly, without building a tuple; a
+/// void result yields expected<void,E>.
+
+template< typename F, typename X, typename... Xs
+    , typename E = detail::error_type_of<X>
+    , typename R = typename std::decay< decltype( std::declval<F>()( *std::declval<X>(), *std::declval<Xs>()... ) ) >::type
+>
+auto zip_with( F && f, X && x, Xs &&... xs )
+    -> expected< typename std::conditional< std::is_void<R>::value, void, R >::type, E >
+{
+    static_assert( detail::same_error_types< E, Xs... >::value, "zip_with(): all error types must be the same" );
+
+    if ( ! detail::all_values( x.has_value(), xs.has_value()... ) )
+        return make_unexpected( detail::first_error_of<E>( std::forward<X>( x ), std::forward<Xs>( xs )... ) );
+
+    return detail::zip_with<R, E>( std::is_void<R>(), std::forward<F>( f ), std::forward<X>( x ), std::forward<Xs>( xs )... );
+}
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_ALGORITHM_LITE_HPP
@@ -0,0 +1,558 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_atomic: atomic load, store, exchange and compare-exchange of an
+// expected<T,E> with trivially copyable T and E.
+
+#ifndef NONSTD_EXPECTED_ATOMIC_LITE_HPP
+#define NONSTD_EXPECTED_ATOMIC_LITE_HPP
+
+#include "expected.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <type_traits>
+
+// Use a 16-byte compare-and-swap if the target provides it (e.g. -mcx16):
+
+#if defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16) && defined(__SIZEOF_INT128__)
+# define nsel_HAVE_CAS128  1
+#else
+# define nsel_HAVE_CAS128  0
+#endif
+
+namespace nonstd { namespace expected_lite {
+
+/// alignment that atomic_expected<P*,E> may assume for the objects a P*
+/// points to. It is alignof(P) for arithmetic, enumeration and pointer types,
+/// and 1 for other types, which may be incomplete where the pointer is used.
+/// Specialize it to let a pointer to such a type carry the has-value flag in
+/// its least significant bit, e.g. as 8 for a forward-declared struct Config
+/// that is 8-byte aligned; the specialization must be visible wherever the
+/// atomic_expected is used.
+
+template< typename P >
+struct pointee_alignment : std::integral_constant< std::size_t, alignof( typename std::conditional<
+    std::is_arithmetic<P>::value || std::is_enum<P>::value || std::is_pointer<P>::value, P, char >::type ) > {};
+
+namespace detail {
+
+/// whether T is a pointer whose least significant bit is always zero, so
+/// that a set bit can tell an error that fits in the other 63 bits.
+
+template< typename T, typename E >
+struct has_pointer_niche : std::false_type {};
+
+template< typename P, typename E >
+struct has_pointer_niche< P *, E > : std::integral_constant< bool,
+    pointee_alignment< typename std::remove_cv<P>::type >::value >= 2
+    && sizeof(P *) <= sizeof(std::uint64_t) && sizeof(E) < sizeof(std::uint64_t) > {};
+
+/// expected<T,E> packed into words: the bytes of the value or error,
+/// followed by one byte that tells which of the two it is.
+
+template< typename T, typename E, bool = has_pointer_niche<T, E>::value >
+struct packed_expected
+{
+    enum { payload = sizeof(T) > sizeof(E) ? sizeof(T) : sizeof(E) };
+    enum { words   = ( payload + 1 + sizeof(std::uint64_t) - 1 ) / sizeof(std::uint64_t) };
+
+    struct type
+    {
+        std::uint64_t w[words];
+    };
+
+    static type pack( expected<T,E> const & e ) noexcept
+    {
+        type r = {};
+        unsigned char * bytes = reinterpret_cast<unsigned char *>( r.w );
+
+        if ( e.has_value() ) std::memcpy( bytes, std::addressof( *e ), sizeof(T) );
+        else                 std::memcpy( bytes, std::addressof( e.error() ), sizeof(E) );
+
+        bytes[ payload ] = static_cast<unsigned char>( e.has_value() );
+        return r;
+    }
+
+    static expected<T,E> unpack( type const & r ) noexcept
+    {
+        unsigned char const * bytes = reinterpret_cast<unsigned char const *>( r.w );
+
+        if ( bytes[ payload ] )
+            return expected<T,E>( copy_of<T>( bytes ) );
+
+        return expected<T,E>( unexpect, copy_of<E>( bytes ) );
+    }
+
+private:
+    template< typename U >
+    static U copy_of( unsigned char const * bytes ) noexcept
+    {
+        alignas(U) unsigned char buffer[ sizeof(U) ];
+        std::memcpy( buffer, bytes, sizeof(U) );
+        return *reinterpret_cast<U *>( buffer );
+    }
+};
+
+/// expected<T*,E> packed into a single word: the pointer as is, or the error
+/// shifted left by one with the least significant bit set.
+
+template< typename T, typename E >
+struct packed_expected< T, E, true >
+{
+    struct type
+    {
+        std::uint64_t w[1];
+    };
+
+    static type pack( expected<T,E> const & e ) noexcept
+    {
+        if ( e.has_value() )
+            return type{ { static_cast<std::uint64_t>( reinterpret_cast<std::uintptr_t>( *e ) ) } };
+
+        return type{ { bits_of( e.error() ) << 1 | 1u } };
+    }
+
+    static expected<T,E> unpack( type const & r ) noexcept
+    {
+        if ( ( r.w[0] & 1u ) == 0 )
+            return expected<T,E>( reinterpret_cast<T>( static_cast<std::uintptr_t>( r.w[0] ) ) );
+
+        return expected<T,E>( unexpect, error_of( r.w[0] >> 1 ) );
+    }
+
+private:
+    // the bytes of the error as a number, independent of byte order:
+
+    static std::uint64_t bits_of( E const & error ) noexcept
+    {
+        unsigned char bytes[ sizeof(E) ];
+        std::memcpy( bytes, std::addressof( error ), sizeof(E) );
+
+        std::uint64_t bits = 0;
+        for ( std::size_t i = 0; i != sizeof(E); ++i )
+            bits |= std::uint64_t( bytes[i] ) << ( 8 * i );
+
+        return bits;
+    }
+
+    static E error_of( std::uint64_t bits ) noexcept
+    {
+        unsigned char bytes[ sizeof(E) ];
+        for ( std::size_t i = 0; i != sizeof(E); ++i )
+            bytes[i] = static_cast<unsigned char>( bits >> ( 8 * i ) );
+
+        alignas(E) unsigned char buffer[ sizeof(E) ];
+        std::memcpy( buffer, bytes, sizeof(E) );
+        return *reinterpret_cast<E *>( buffer );
+    }
+};
+
+/// packed expected in several words, guarded by a seqlock. Its lock and
+/// unlock give acquire and release ordering; a seq_cst operation adds a
+/// seq_cst fence ahead of reading and after publishing, so that it takes
+/// part in the single total order of seq_cst operations.
+
+template< typename Repr, std::size_t Words = sizeof(Repr) / sizeof(std::uint64_t) >
+class atomic_repr
+{
+public:
+    static constexpr bool is_always_lock_free = false;
+
+    explicit atomic_repr( Repr const & r ) noexcept
+        : m_seq( 0 )
+    {
+        for ( std::size_t i = 0; i != Words; ++i )
+            m_w[i].store( r.w[i], std::memory_order_relaxed );
+    }
+
+    bool is_lock_free() const noexcept
+    {
+        return false;
+    }
+
+    Repr load( std::memory_order order ) const noexcept
+    {
+        fence_if_seq_cst( order );
+
+        for (;;)
+        {
+            const unsigned before = m_seq.load( std::memory_order_acquire );
+
+            if ( before & 1u )
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            Repr r;
+            read( r );
+
+            std::atomic_thread_fence( std::memory_order_acquire );
+
+            if ( m_seq.load( std::memory_order_relaxed ) == before )
+                return r;
+        }
+    }
+
+    void store( Repr const & desired, std::memory_order order ) noexcept
+    {
+        const unsigned seq = lock();
+        write( desired );
+        unlock( seq );
+
+        fence_if_seq_cst( order );
+    }
+
+    Repr exchange( Repr const & desired, std::memory_order order ) noexcept
+    {
+        fence_if_seq_cst( order );
+
+        const unsigned seq = lock();
+
+        Repr previous;
+        read( previous );
+        write( desired );
+
+        unlock( seq );
+
+        fence_if_seq_cst( order );
+        return previous;
+    }
+
+    bool compare_exchange( Repr & expect, Repr const & desired, std::memory_order success, std::memory_order failure ) noexcept
+    {
+        const bool seq_cst = success == std::memory_order_seq_cst || failure == std::memory_order_seq_cst;
+
+        if ( seq_cst ) std::atomic_thread_fence( std::memory_order_seq_cst );
+
+        const unsigned seq = lock();
+
+        Repr current;
+        read( current );
+
+        const bool equal = 0 == std::memcmp( current.w, expect.w, sizeof(current.w) );
+
+        if ( equal ) write( desired );
+        else         expect = current;
+
+        unlock( seq );
+
+        if ( seq_cst ) std::atomic_thread_fence( std::memory_order_seq_cst );
+        return equal;
+    }
+
+private:
+    // seqlock: writers make the sequence odd for the duration of a write;
+    // readers retry if it was odd or changed while they read the words.
+
+    unsigned lock() noexcept
+    {
+        unsigned seq = m_seq.load( std::memory_order_relaxed );
+
+        for (;;)
+        {
+            if ( ( seq & 1u ) == 0 && m_seq.compare_exchange_weak( seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed ) )
+                break;
+
+            std::this_thread::yield();
+            seq = m_seq.load( std::memory_order_relaxed );
+        }
+
+        std::atomic_thread_fence( std::memory_order_release );
+        return seq;
+    }
+
+    void unlock( unsigned seq ) noexcept
+    {
+        m_seq.store( seq + 2, std::memory_order_release );
+    }
+
+    void read( Repr & r ) const noexcept
+    {
+        for ( std::size_t i = 0; i != Words; ++i )
+            r.w[i] = m_w[i].load( std::memory_order_relaxed );
+    }
+
+    void write( Repr const & r ) noexcept
+    {
+        for ( std::size_t i = 0; i != Words; ++i )
+            m_w[i].store( r.w[i], std::memory_order_relaxed );
+    }
+
+    static void fence_if_seq_cst( std::memory_order order ) noexcept
+    {
+        if ( order == std::memory_order_seq_cst )
+            std::atomic_thread_fence( std::memory_order_seq_cst );
+    }
+
+private:
+    std::atomic<unsigned>      m_seq;
+    std::atomic<std::uint64_t> m_w[Words];
+};
+
+template< typename Repr, std::size_t Words >
+constexpr bool atomic_repr<Repr, Words>::is_always_lock_free;
+
+/// packed expected in a single 64-bit atomic word.
+
+template< typename Repr >
+class atomic_repr< Repr, 1 >
+{
+public:
+    static constexpr bool is_always_lock_free = ATOMIC_LLONG_LOCK_FREE == 2;
+
+    explicit atomic_repr( Repr const & r ) noexcept
+        : m_w( r.w[0] )
+    {}
+
+    bool is_lock_free() const noexcept
+    {
+        return m_w.is_lock_free();
+    }
+
+    Repr load( std::memory_order order ) const noexcept
+    {
+        return Repr{ { m_w.load( order ) } };
+    }
+
+    void store( Repr const & desired, std::memory_order order ) noexcept
+    {
+        m_w.store( desired.w[0], order );
+    }
+
+    Repr exchange( Repr const & desired, std::memory_order order ) noexcept
+    {
+        return Repr{ { m_w.exchange( desired.w[0], order ) } };
+    }
+
+    bool compare_exchange( Repr & expect, Repr const & desired, std::memory_order success, std::memory_order failure ) noexcept
+    {
+        return m_w.compare_exchange_strong( expect.w[0], desired.w[0], success, failure );
+    }
+
+private:
+    std::atomic<std::uint64_t> m_w;
+};
+
+template< typename Repr >
+constexpr bool atomic_repr<Repr, 1>::is_always_lock_free;
+
+#if nsel_HAVE_CAS128
+
+/// packed expected in a 128-bit word, accessed via 16-byte compare-and-swap.
+/// There is no plain 16-byte atomic load, so load() is a compare-and-swap
+/// too: every reader takes the cache line exclusively, and concurrent readers
+/// contend like writers. For read-mostly use with many readers, the seqlock
+/// of the general case may scale better.
+
+template< typename Repr >
+class atomic_repr< Repr, 2 >
+{
+public:
+    static constexpr bool is_always_lock_free = true;
+
+    explicit atomic_repr( Repr const & r ) noexcept
+        : m_w( to_word( r ) )
+    {}
+
+    bool is_lock_free() const noexcept
+    {
+        return true;
+    }
+
+    Repr load( std::memory_order ) const noexcept
+    {
+        return to_repr( __sync_val_compare_and_swap( &m_w, word(), word() ) );
+    }
+
+    void store( Repr const & desired, std::memory_order order ) noexcept
+    {
+        (void) exchange( desired, order );
+    }
+
+    Repr exchange( Repr const & desired, std::memory_order ) noexcept
+    {
+        word current = guess();
+        word previous;
+
+        while ( ( previous = __sync_val_compare_and_swap( &m_w, current, to_word( desired ) ) ) != current )
+            current = previous;
+
+        return to_repr( previous );
+    }
+
+    bool compare_exchange( Repr & expect, Repr const & desired, std::memory_order, std::memory_order ) noexcept
+    {
+        const word wanted   = to_word( expect );
+        const word previous = __sync_val_compare_and_swap( &m_w, wanted, to_word( desired ) );
+
+        expect = to_repr( previous );
+        return previous == wanted;
+    }
+
+private:
+    using word = unsigned __int128;
+
+    // the current word for a first compare-and-swap, read as two relaxed
+    // 64-bit atomic loads; it may be torn, which only costs a retry.
+
+    word guess() const noexcept
+    {
+        std::uint64_t const * half = reinterpret_cast<std::uint64_t const *>( &m_w );
+
+        std::uint64_t const h[2] = { __atomic_load_n( half, __ATOMIC_RELAXED ), __atomic_load_n( half + 1, __ATOMIC_RELAXED ) };
+
+        word w;
+        std::memcpy( &w, h, sizeof(w) );
+        return w;
+    }
+
+    static word to_word( Repr const & r ) noexcept
+    {
+        word w;
+        std::memcpy( &w, r.w, sizeof(w) );
+        return w;
+    }
+
+    static Repr to_repr( word w ) noexcept
+    {
+        Repr r;
+        std::memcpy( r.w, &w, sizeof(w) );
+        return r;
+    }
+
+private:
+    alignas(16) mutable word m_w;
+};
+
+template< typename Repr >
+constexpr bool atomic_repr<Repr, 2>::is_always_lock_free;
+
+#endif // nsel_HAVE_CAS128
+
+} // namespace detail
+
+/// atomically accessible expected<T,E> for trivially copyable T and E.
+///
+/// The value or error and the has-value flag are packed together into as
+/// few 64-bit words as possible. For a pointer T to an object that is at
+/// least 2-byte aligned according to pointee_alignment and an E of less than
+/// 8 bytes, the flag is the pointer's least significant bit, so they fit in
+/// one word. One word is
+/// accessed with 64-bit atomics, two words with a 16-byte compare-and-swap
+/// if the target has one; larger ones, or two words without such an
+/// instruction, use a seqlock. Like std::atomic, compare_exchange_*()
+/// compares object representations.
+
+template< typename T, typename E >
+class atomic_expected
+{
+    static_assert( std::is_trivially_copyable<T>::value && std::is_trivially_copyable<E>::value
+        , "atomic_expected<T,E> requires trivially copyable T and E" );
+
+    using packed = detail::packed_expected<T, E>;
+    using repr   = typename packed::type;
+
+public:
+    using value_type = expected<T, E>;
+
+    static constexpr bool is_always_lock_free = detail::atomic_repr<repr>::is_always_lock_free;
+
+    atomic_expected() noexcept
+        : m_repr( packed::pack( value_type() ) )
+    {}
+
+    atomic_expected( value_type const & e ) noexcept
+        : m_repr( packed::pack( e ) )
+    {}
+
+    atomic_expected( atomic_expected const & ) = delete;
+    atomic_expected & operator=( atomic_expected const & ) = delete;
+
+    value_type operator=( value_type const & e ) noexcept
+    {
+        store( e );
+        return e;
+    }
+
+    operator value_type() const noexcept
+    {
+        return load();
+    }
+
+    bool is_lock_free() const noexcept
+    {
+        return m_repr.is_lock_free();
+    }
+
+    value_type load( std::memory_order order = std::memory_order_seq_cst ) const noexcept
+    {
+        return packed::unpack( m_repr.load( order ) );
+    }
+
+    void store( value_type const & desired, std::memory_order order = std::memory_order_seq_cst ) noexcept
+    {
+        m_repr.store( packed::pack( desired ), order );
+    }
+
+    value_type exchange( value_type const & desired, std::memory_order order = std::memory_order_seq_cst ) noexcept
+    {
+        return packed::unpack( m_repr.exchange( packed::pack( desired ), order ) );
+    }
+
+    bool compare_exchange_strong( value_type & expect, value_type const & desired
+        , std::memory_order success, std::memory_order failure ) noexcept
+    {
+        repr r = packed::pack( expect );
+
+        if ( m_repr.compare_exchange( r, packed::pack( desired ), success, failure ) )
+            return true;
+
+        expect = packed::unpack( r );
+        return false;
+    }
+
+    bool compare_exchange_strong( value_type & expect, value_type const & desired
+        , std::memory_order order = std::memory_order_seq_cst ) noexcept
+    {
+        return compare_exchange_strong( expect, desired, order, failure_order( order ) );
+    }
+
+    bool compare_exchange_weak( value_type & expect, value_type const & desired
+        , std::memory_order success, std::memory_order failure ) noexcept
+    {
+        return compare_exchange_strong( expect, desired, success, failure );
+    }
+
+    bool compare_exchange_weak( value_type & expect, value_type const & desired
+        , std::memory_order order = std::memory_order_seq_cst ) noexcept
+    {
+        return compare_exchange_strong( expect, desired, order );
+    }
+
+private:
+    static std::memory_order failure_order( std::memory_order order ) noexcept
+    {
+        return order == std::memory_order_acq_rel ? std::memory_order_acquire
+             : order == std::memory_order_release ? std::memory_order_relaxed : order;
+    }
+
+private:
+    detail::atomic_repr<repr> m_repr;
+};
+
+template< typename T, typename E >
+constexpr bool atomic_expected<T, E>::is_always_lock_free;
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_ATOMIC_LITE_HPP
@@ -0,0 +1,541 @@
+// This version targets C++20 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_coroutine: use expected<T,E> as coroutine return type, where
+// co_await on an expected yields its value or returns its error.
+
+#ifndef NONSTD_EXPECTED_COROUTINE_LITE_HPP
+#define NONSTD_EXPECTED_COROUTINE_LITE_HPP
+
+#include "expected.hpp"
+
+// Coroutine support requires C++20 coroutines, nonstd::expected and a
+// compiler that converts the return object only after the coroutine returns
+// or first suspends: GCC 10, Clang 17, MSVC 19.28 or later:
+
+#if defined(__clang__)
+# define nsel_COROUTINE_RETURN_DELAYED  ( __clang_major__ >= 17 )
+#elif defined(_MSC_VER)
+# define nsel_COROUTINE_RETURN_DELAYED  ( _MSC_VER >= 1928 )
+#elif defined(__GNUC__)
+# define nsel_COROUTINE_RETURN_DELAYED  ( __GNUC__ >= 10 )
+#else
+# define nsel_COROUTINE_RETURN_DELAYED  0
+#endif
+
+#if nsel_CPP20_OR_GREATER && !nsel_USES_STD_EXPECTED && nsel_COROUTINE_RETURN_DELAYED && defined(__cpp_impl_coroutine) && defined(__has_include)
+# if __has_include( <coroutine> )
+#  define nsel_HAVE_COROUTINES  1
+# else
+#  define nsel_HAVE_COROUTINES  0
+# endif
+#else
+# define  nsel_HAVE_COROUTINES  0
+#endif
+
+// Number of coroutine frames a thread keeps per size class for reuse:
+
+#ifndef  nsel_CONFIG_COROUTINE_FRAME_CACHE
+# define nsel_CONFIG_COROUTINE_FRAME_CACHE  16
+#endif
+
+#if nsel_HAVE_COROUTINES
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace nonstd { namespace expected_lite {
+
+namespace detail {
+
+/// called with the frame address and size to free a coroutine frame.
+
+using frame_release = void (*)( void * frame, std::size_t size ) noexcept;
+
+constexpr std::size_t frame_round_up( std::size_t n ) noexcept
+{
+    return ( n + alignof(std::max_align_t) - 1 ) & ~( alignof(std::max_align_t) - 1 );
+}
+
+inline void set_frame_release( void * frame, frame_release release ) noexcept
+{
+    ::new( static_cast<char *>( frame ) - sizeof(frame_release) ) frame_release( release );
+}
+
+inline frame_release get_frame_release( void * frame ) noexcept
+{
+    return *std::launder( reinterpret_cast<frame_release *>( static_cast<char *>( frame ) - sizeof(frame_release) ) );
+}
+
+/// frame that a return object destroyed before it rethrew the exception that
+/// escaped the coroutine. GCC 12 frees the frame of a call that exits via an
+/// exception once more, which operator delete then ignores; allocating the
+/// next frame of the thread forgets it.
+
+inline void * & destroyed_frame() noexcept
+{
+    static thread_local void * frame = nullptr;
+    return frame;
+}
+
+/// per-thread cache of coroutine frames in size classes of 64 bytes up to
+/// 1 KiB; larger frames come from global new.
+
+class frame_cache
+{
+public:
+    enum { header = frame_round_up( sizeof(frame_release) ) };
+    enum { granularity = 64, classes = 16 };
+
+    static constexpr std::size_t capacity = nsel_CONFIG_COROUTINE_FRAME_CACHE;
+
+    static void * allocate( std::size_t size )
+    {
+        const std::size_t k = size_class( size );
+        void * base = nullptr;
+
+        if ( k < classes && instance().m_count[k] != 0 )
+        {
+            free_block * block = instance().m_free[k];
+            instance().m_free[k] = block->next;
+            --instance().m_count[k];
+            base = block;
+        }
+        else
+        {
+            base = ::operator new( k < classes ? ( k + 1 ) * granularity : header + size );
+        }
+
+        void * frame = static_cast<char *>( base ) + header;
+        set_frame_release( frame, &release );
+        return frame;
+    }
+
+    static void release( void * frame, std::size_t size ) noexcept
+    {
+        void * base = static_cast<char *>( frame ) - header;
+        const std::size_t k = size_class( size );
+
+        if ( k < classes && instance().m_count[k] + 1 <= capacity )
+        {
+            instance().m_free[k] = ::new( base ) free_block{ instance().m_free[k] };
+            ++instance().m_count[k];
+        }
+        else
+        {
+            ::operator delete( base );
+        }
+    }
+
+private:
+    struct free_block
+    {
+        free_block * next;
+    };
+
+    static std::size_t size_class( std::size_t size ) noexcept
+    {
+        return ( header + size - 1 ) / granularity;
+    }
+
+    static frame_cache & instance() noexcept
+    {
+        static thread_local frame_cache cache;
+        return cache;
+    }
+
+    frame_cache() = default;
+
+    ~frame_cache()
+    {
+        for ( auto head : m_free )
+        {
+            while ( head )
+            {
+                free_block * next = head->next;
+                ::operator delete( head );
+                head = next;
+            }
+        }
+    }
+
+    free_block * m_free [classes] = {};
+    std::size_t  m_count[classes] = {};
+};
+
+/// coroutine frames from allocator Alloc, which is kept in front of the frame.
+
+template< typename Alloc >
+struct frame_allocator
+{
+    using byte_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<std::max_align_t>;
+    using traits     = std::allocator_traits<byte_alloc>;
+
+    static constexpr std::size_t header = frame_round_up( sizeof(byte_alloc) + sizeof(frame_release) );
+
+    static std::size_t blocks( std::size_t size ) noexcept
+    {
+        return ( header + size + sizeof(std::max_align_t) - 1 ) / sizeof(std::max_align_t);
+    }
+
+    static void * allocate( Alloc const & alloc, std::size_t size )
+    {
+        byte_alloc a( alloc );
+        void * base  = std::to_address( traits::allocate( a, blocks( size ) ) );
+        void * frame = static_cast<char *>( base ) + header;
+
+        ::new( base ) byte_alloc( std::move( a ) );
+        set_frame_release( frame, &release );
+        return frame;
+    }
+
+    static void release( void * frame, std::size_t size ) noexcept
+    {
+        void * base = static_cast<char *>( frame ) - header;
+        byte_alloc & stored = *std::launder( static_cast<byte_alloc *>( base ) );
+        byte_alloc a( std::move( stored ) );
+
+        stored.~byte_alloc();
+        traits::deallocate( a, static_cast<std::max_align_t *>( base ), blocks( size ) );
+    }
+};
+
+/// where the result of an expected coroutine is placed; lives in its return
+/// object. An exception that escapes the coroutine is kept instead, with the
+/// coroutine suspended at its final suspend point, until take() destroys the
+/// coroutine and rethrows it.
+
+template< typename T, typename E >
+class coroutine_result
+{
+public:
+    coroutine_result() noexcept {}
+
+    coroutine_result( coroutine_result const & ) = delete;
+
+    ~coroutine_result()
+    {
+        if ( m_engaged )
+            m_value.~expected();
+    }
+
+    template< typename... Args >
+    void emplace( Args&&... args )
+    {
+        assert( ! m_engaged );
+        ::new( &m_value ) expected<T,E>( std::forward<Args>( args )... );
+        m_engaged = true;
+    }
+
+    void set_exception( std::exception_ptr e ) noexcept
+    {
+        assert( ! m_engaged );
+        m_exception = std::move( e );
+    }
+
+    bool has_exception() const noexcept
+    {
+        return !! m_exception;
+    }
+
+    void keep_frame( std::coroutine_handle<> h ) noexcept
+    {
+        m_frame = h;
+    }
+
+    expected<T,E> take()
+    {
+        if ( m_exception )
+        {
+            void * frame = m_frame.address();
+
+            m_frame.destroy();
+            destroyed_frame() = frame;
+            std::rethrow_exception( m_exception );
+        }
+
+        assert( m_engaged );
+        return std::move( m_value );
+    }
+
+private:
+    union
+    {
+        expected<T,E> m_value;
+    };
+    std::exception_ptr      m_exception;
+    std::coroutine_handle<> m_frame;
+    bool m_engaged = false;
+};
+
+/// final awaiter: suspends only to keep the frame of a coroutine that an
+/// exception escaped, for the return object to destroy.
+
+template< typename T, typename E >
+class final_awaiter
+{
+public:
+    explicit final_awaiter( coroutine_result<T,E> * slot ) noexcept
+        : m_slot( slot )
+    {}
+
+    bool await_ready() const noexcept
+    {
+        return ! m_slot->has_exception();
+    }
+
+    void await_suspend( std::coroutine_handle<> h ) const noexcept
+    {
+        m_slot->keep_frame( h );
+    }
+
+    void await_resume() const noexcept {}
+
+private:
+    coroutine_result<T,E> * m_slot;
+};
+
+/// return object: converted to expected<T,E> after the coroutine returns or
+/// suspends on an error, which requires the conversion to be delayed until
+/// then, as do GCC 10, Clang 17, MSVC 19.28 and later.
+
+template< typename T, typename E >
+class coroutine_return
+{
+public:
+    explicit coroutine_return( coroutine_result<T,E> * & slot ) noexcept
+        : m_slot( slot )
+    {
+        m_slot = &m_result;
+    }
+
+    coroutine_return( coroutine_return && other ) noexcept
+        : m_slot( other.m_slot )
+    {
+        m_slot = &m_result;
+    }
+
+    operator expected<T,E>()
+    {
+        return m_result.take();
+    }
+
+private:
+    coroutine_result<T,E>    m_result;
+    coroutine_result<T,E> *& m_slot;
+};
+
+/// awaiter for co_await on an expected or unexpected_type: resumes with the
+/// value, or places the error as result and destroys the coroutine.
+
+template< typename X >
+class expected_awaiter
+{
+public:
+    explicit expected_awaiter( X && x ) noexcept
+        : m_x( std::forward<X>( x ) )
+    {}
+
+    bool await_ready() const noexcept
+    {
+        return m_x.has_value();
+    }
+
+    template< typename Promise >
+    void await_suspend( std::coroutine_handle<Promise> h )
+    {
+        h.promise().set_error( std::forward<X>( m_x ).error() );
+        h.destroy();
+    }
+
+    decltype(auto) await_resume()
+    {
+        using value_type = typename std20::remove_cvref<X>::type::value_type;
+
+        if constexpr ( std::is_void<value_type>::value )
+            return;
+        else
+            return *std::forward<X>( m_x );
+    }
+
+private:
+    X && m_x;
+};
+
+template< typename X >
+class unexpected_awaiter
+{
+public:
+    explicit unexpected_awaiter( X && x ) noexcept
+        : m_x( std::forward<X>( x ) )
+    {}
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    template< typename Promise >
+    void await_suspend( std::coroutine_handle<Promise> h )
+    {
+        h.promise().set_error( std::forward<X>( m_x ).value() );
+        h.destroy();
+    }
+
+    [[noreturn]] void await_resume() noexcept
+    {
+        std::terminate();
+    }
+
+private:
+    X && m_x;
+};
+
+template< typename X >
+struct is_expected : std::false_type {};
+
+template< typename T, typename E >
+struct is_expected< expected<T,E> > : std::true_type {};
+
+template< typename X >
+struct is_unexpected : std::false_type {};
+
+template< typename E >
+struct is_unexpected< unexpected_type<E> > : std::true_type {};
+
+/// promise parts common to expected<T,E> and expected<void,E>.
+
+template< typename T, typename E >
+class coroutine_promise_base
+{
+public:
+    // frame allocation: from a leading std::allocator_arg_t, Alloc pair of
+    // coroutine parameters if present, otherwise from the per-thread cache.
+
+    static void * operator new( std::size_t size )
+    {
+        destroyed_frame() = nullptr;
+        return frame_cache::allocate( size );
+    }
+
+    template< typename Alloc, typename... Args >
+    static void * operator new( std::size_t size, std::allocator_arg_t, Alloc const & alloc, Args const &... )
+    {
+        destroyed_frame() = nullptr;
+        return frame_allocator<Alloc>::allocate( alloc, size );
+    }
+
+    template< typename Class, typename Alloc, typename... Args >
+    static void * operator new( std::size_t size, Class const &, std::allocator_arg_t, Alloc const & alloc, Args const &... )
+    {
+        destroyed_frame() = nullptr;
+        return frame_allocator<Alloc>::allocate( alloc, size );
+    }
+
+    static void operator delete( void * frame, std::size_t size ) noexcept
+    {
+        if ( frame == destroyed_frame() )
+        {
+            destroyed_frame() = nullptr;
+            return;
+        }
+        get_frame_release( frame )( frame, size );
+    }
+
+    coroutine_return<T,E> get_return_object() noexcept
+    {
+        return coroutine_return<T,E>( m_slot );
+    }
+
+    std::suspend_never initial_suspend() const noexcept
+    {
+        return {};
+    }
+
+    final_awaiter<T,E> final_suspend() const noexcept
+    {
+        return final_awaiter<T,E>( m_slot );
+    }
+
+    // an exception becomes the error if E is constructible from
+    // std::exception_ptr; otherwise the return object rethrows it.
+
+    void unhandled_exception() noexcept
+    {
+        if constexpr ( std::is_constructible<E, std::exception_ptr>::value )
+            set_error( std::current_exception() );
+        else
+            m_slot->set_exception( std::current_exception() );
+    }
+
+    template< typename G >
+    void set_error( G && error )
+    {
+        m_slot->emplace( unexpect, std::forward<G>( error ) );
+    }
+
+    template< typename X
+        , typename std::enable_if< is_expected< typename std20::remove_cvref<X>::type >::value, int >::type = 0
+    >
+    expected_awaiter<X> await_transform( X && x ) noexcept
+    {
+        return expected_awaiter<X>( std::forward<X>( x ) );
+    }
+
+    template< typename X
+        , typename std::enable_if< is_unexpected< typename std20::remove_cvref<X>::type >::value, int >::type = 0
+    >
+    unexpected_awaiter<X> await_transform( X && x ) noexcept
+    {
+        return unexpected_awaiter<X>( std::forward<X>( x ) );
+    }
+
+protected:
+    coroutine_result<T,E> * m_slot = nullptr;
+};
+
+template< typename T, typename E >
+class coroutine_promise : public coroutine_promise_base<T,E>
+{
+public:
+    template< typename U = T >
+    void return_value( U && v )
+    {
+        this->m_slot->emplace( std::forward<U>( v ) );
+    }
+};
+
+template< typename E >
+class coroutine_promise<void, E> : public coroutine_promise_base<void, E>
+{
+public:
+    void return_void()
+    {
+        this->m_slot->emplace();
+    }
+};
+
+} // namespace detail
+
+}} // namespace nonstd::expected_lite
+
+/// make expected<T,E> a coroutine type.
+
+template< typename T, typename E, typename... Args >
+struct std::coroutine_traits< nonstd::expected<T,E>, Args... >
+{
+    using promise_type = nonstd::expected_lite::detail::coroutine_promise<T,E>;
+};
+
+#endif // nsel_HAVE_COROUTINES
+
+#endif // NONSTD_EXPECTED_COROUTINE_LITE_HPP
@@ -0,0 +1,389 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_deadline: call a function under a deadline or a cancellation
+// token, and receive its result, or why it was stopped, as expected.
+
+#ifndef NONSTD_EXPECTED_DEADLINE_LITE_HPP
+#define NONSTD_EXPECTED_DEADLINE_LITE_HPP
+
+#include "expected.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Number of stop_requested() calls between reads of the clock:
+
+#ifndef  nsel_CONFIG_DEADLINE_CHECK_INTERVAL
+# define nsel_CONFIG_DEADLINE_CHECK_INTERVAL  64
+#endif
+
+namespace nonstd { namespace expected_lite {
+
+/// why a call was stopped, if it was.
+
+enum class interruption
+{
+    none,
+    cancelled,
+    timeout
+};
+
+/// error of a call under a deadline or cancellation token: either the error
+/// E of the function called, or the interruption that stopped the call.
+
+template< typename E >
+class cancelled_or_timeout
+{
+public:
+    using error_type = E;
+
+    cancelled_or_timeout( E const & e )
+        : m_error( e )
+    {}
+
+    cancelled_or_timeout( E && e )
+        : m_error( std::move( e ) )
+    {}
+
+    static cancelled_or_timeout cancelled()
+    {
+        return cancelled_or_timeout( interruption::cancelled );
+    }
+
+    static cancelled_or_timeout timeout()
+    {
+        return cancelled_or_timeout( interruption::timeout );
+    }
+
+    /// interruption::none if this holds an error of the function.
+
+    interruption reason() const noexcept
+    {
+        return m_error.has_value() ? interruption::none : m_error.error();
+    }
+
+    bool is_cancelled() const noexcept
+    {
+        return reason() == interruption::cancelled;
+    }
+
+    bool is_timeout() const noexcept
+    {
+        return reason() == interruption::timeout;
+    }
+
+    bool has_error() const noexcept
+    {
+        return m_error.has_value();
+    }
+
+    /// the error of the function; requires has_error().
+
+    E const & error() const &
+    {
+        return *m_error;
+    }
+
+    E & error() &
+    {
+        return *m_error;
+    }
+
+    E && error() &&
+    {
+        return std::move( *m_error );
+    }
+
+    friend bool operator==( cancelled_or_timeout const & x, cancelled_or_timeout const & y )
+    {
+        return x.m_error == y.m_error;
+    }
+
+    friend bool operator!=( cancelled_or_timeout const & x, cancelled_or_timeout const & y )
+    {
+        return !( x == y );
+    }
+
+private:
+    explicit cancelled_or_timeout( interruption why )
+        : m_error( unexpect, why )
+    {}
+
+    expected<E, interruption> m_error;
+};
+
+// -----------------------------------------------------------------------
+// cancellation
+
+/// view of the cancellation state of a cancellation_source; a default
+/// constructed token is never cancelled.
+
+class cancellation_token
+{
+public:
+    cancellation_token() noexcept
+        : m_cancelled( nullptr )
+    {}
+
+    explicit cancellation_token( std::atomic<bool> const & cancelled ) noexcept
+        : m_cancelled( &cancelled )
+    {}
+
+    bool stop_requested() const noexcept
+    {
+        return m_cancelled && m_cancelled->load( std::memory_order_relaxed );
+    }
+
+private:
+    std::atomic<bool> const * m_cancelled;
+};
+
+/// owner of a cancellation state; must outlive its tokens.
+
+class cancellation_source
+{
+public:
+    cancellation_source() noexcept
+        : m_cancelled( false )
+    {}
+
+    cancellation_source( cancellation_source const & ) = delete;
+    cancellation_source & operator=( cancellation_source const & ) = delete;
+
+    void request_stop() noexcept
+    {
+        m_cancelled.store( true, std::memory_order_relaxed );
+    }
+
+    bool stop_requested() const noexcept
+    {
+        return m_cancelled.load( std::memory_order_relaxed );
+    }
+
+    cancellation_token token() const noexcept
+    {
+        return cancellation_token( m_cancelled );
+    }
+
+private:
+    std::atomic<bool> m_cancelled;
+};
+
+// -----------------------------------------------------------------------
+// cooperative stop points
+
+/// passed to a function called by call_with_deadline() or cancellable(),
+/// which calls stop_requested() at its cooperative points and returns early
+/// if it yields true.
+///
+/// stop_requested() loads the token on each call, but reads the steady clock
+/// only once per nsel_CONFIG_DEADLINE_CHECK_INTERVAL calls; refresh() reads it
+/// at once, e.g. at the start of a batch. Once stopped, it stays stopped.
+
+class stop_check
+{
+public:
+    using clock = std::chrono::steady_clock;
+
+    stop_check( cancellation_token token, clock::time_point deadline ) noexcept
+        : m_token( token )
+        , m_deadline( deadline )
+        , m_has_deadline( deadline != clock::time_point::max() )
+        , m_count( 0 )
+        , m_reason( interruption::none )
+    {}
+
+    bool stop_requested() noexcept
+    {
+        if ( m_reason != interruption::none )
+            return true;
+
+        if ( m_token.stop_requested() )
+        {
+            m_reason = interruption::cancelled;
+            return true;
+        }
+
+        if ( ++m_count == nsel_CONFIG_DEADLINE_CHECK_INTERVAL )
+        {
+            m_count = 0;
+            refresh();
+        }
+        return m_reason != interruption::none;
+    }
+
+    /// read the token and the clock now, and stop if cancelled or if the
+    /// deadline has passed.
+
+    void refresh() noexcept
+    {
+        if ( m_reason != interruption::none )
+            return;
+
+        if ( m_token.stop_requested() )
+            m_reason = interruption::cancelled;
+        else if ( m_has_deadline && clock::now() >= m_deadline )
+            m_reason = interruption::timeout;
+    }
+
+    interruption reason() const noexcept
+    {
+        return m_reason;
+    }
+
+private:
+    cancellation_token m_token;
+    clock::time_point  m_deadline;
+    bool               m_has_deadline;
+    int                m_count;
+    interruption       m_reason;
+};
+
+namespace detail {
+
+/// expected<T, cancelled_or_timeout<E>> for a function result expected<T,E>;
+/// a result that already has such an error type is kept.
+
+template< typename R >
+struct stoppable_result;
+
+template< typename T, typename E >
+struct stoppable_result< expected<T, E> >
+{
+    using type = expected< T, cancelled_or_timeout<E> >;
+};
+
+template< typename T, typename E >
+struct stoppable_result< expected< T, cancelled_or_timeout<E> > >
+{
+    using type = expected< T, cancelled_or_timeout<E> >;
+};
+
+template< typename T, typename E >
+expected< T, cancelled_or_timeout<E> > to_stoppable( expected<T, E> && e, std::false_type /*void*/ )
+{
+    if ( e.has_value() )
+        return expected< T, cancelled_or_timeout<E> >( std::move( *e ) );
+
+    return expected< T, cancelled_or_timeout<E> >( unexpect, std::move( e ).error() );
+}
+
+template< typename T, typename E >
+expected< T, cancelled_or_timeout<E> > to_stoppable( expected<T, E> && e, std::true_type /*void*/ )
+{
+    if ( e.has_value() )
+        return expected< T, cancelled_or_timeout<E> >();
+
+    return expected< T, cancelled_or_timeout<E> >( unexpect, std::move( e ).error() );
+}
+
+template< typename T, typename E >
+expected< T, cancelled_or_timeout<E> > to_stoppable( expected< T, cancelled_or_timeout<E> > && e, std::false_type /*void*/ )
+{
+    return std::move( e );
+}
+
+template< typename T, typename E >
+expected< T, cancelled_or_timeout<E> > to_stoppable( expected< T, cancelled_or_timeout<E> > && e, std::true_type /*void*/ )
+{
+    return std::move( e );
+}
+
+/// call f( stop ) if f accepts a stop_check, otherwise f().
+
+template< typename F >
+auto invoke_stoppable( F & f, stop_check & stop, int ) -> decltype( f( stop ) )
+{
+    return f( stop );
+}
+
+template< typename F >
+auto invoke_stoppable( F & f, stop_check &, long ) -> decltype( f() )
+{
+    return f();
+}
+
+template< typename F >
+using stoppable_call_result = typename std::decay< decltype( invoke_stoppable( std::declval<F &>(), std::declval<stop_check &>(), 0 ) ) >::type;
+
+template< typename F
+    , typename R = typename stoppable_result< stoppable_call_result<F> >::type
+>
+R call_stoppable( cancellation_token token, stop_check::clock::time_point deadline, F & f )
+{
+    using error_type = typename R::error_type;
+
+    stop_check stop( token, deadline );
+
+    // shed the call if stopped before it starts:
+
+    stop.refresh();
+
+    if ( stop.reason() == interruption::none )
+    {
+        auto result = invoke_stoppable( f, stop, 0 );
+
+        if ( stop.reason() == interruption::none )
+            return to_stoppable( std::move( result ), std::is_void< typename R::value_type >() );
+    }
+
+    return R( unexpect, stop.reason() == interruption::cancelled ? error_type::cancelled() : error_type::timeout() );
+}
+
+} // namespace detail
+
+/// call f before deadline: yields the value or error of the expected<T,E>
+/// that f returns as expected<T, cancelled_or_timeout<E>>, or timeout if the
+/// deadline has passed before f starts or when f stops at a stop_check.
+/// f is called as f( stop_check & ) if it accepts one, otherwise as f().
+/// A result with error type cancelled_or_timeout<E> is passed on as is, so
+/// that nested calls compose.
+
+template< typename F
+    , typename R = typename detail::stoppable_result< detail::stoppable_call_result<F> >::type
+>
+R call_with_deadline( std::chrono::steady_clock::time_point deadline, F f )
+{
+    return detail::call_stoppable( cancellation_token(), deadline, f );
+}
+
+template< typename Rep, typename Period, typename F
+    , typename R = typename detail::stoppable_result< detail::stoppable_call_result<F> >::type
+>
+R call_with_deadline( std::chrono::duration<Rep, Period> const & timeout, F f )
+{
+    return detail::call_stoppable( cancellation_token(), std::chrono::steady_clock::now() + timeout, f );
+}
+
+/// same, stopping at the deadline or when token is cancelled.
+
+template< typename F
+    , typename R = typename detail::stoppable_result< detail::stoppable_call_result<F> >::type
+>
+R call_with_deadline( std::chrono::steady_clock::time_point deadline, cancellation_token token, F f )
+{
+    return detail::call_stoppable( token, deadline, f );
+}
+
+/// call f unless token is cancelled; yields cancelled if it is cancelled
+/// before f starts or when f stops at a stop_check. Never reads the clock.
+
+template< typename F
+    , typename R = typename detail::stoppable_result< detail::stoppable_call_result<F> >::type
+>
+R cancellable( cancellation_token token, F f )
+{
+    return detail::call_stoppable( token, std::chrono::steady_clock::time_point::max(), f );
+}
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_DEADLINE_LITE_HPP
@@ -0,0 +1,123 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_fwd: declarations of expected, unexpected_type, unexpect_t and
+// bad_expected_access, for headers that only name them in declarations.
+// Include nonstd/expected.hpp where the types must be complete.
+//
+// Honours nsel_CONFIG_SELECT_EXPECTED and nsel_P0323R as expected.hpp does;
+// with std::expected selected, it includes <expected>.
+
+#ifndef NONSTD_EXPECTED_FWD_LITE_HPP
+#define NONSTD_EXPECTED_FWD_LITE_HPP
+
+// nothing to declare when expected.hpp is already included:
+
+#ifndef NONSTD_EXPECTED_LITE_HPP
+
+// configuration, the same as in expected.hpp:
+
+#define nsel_EXPECTED_DEFAULT  0
+#define nsel_EXPECTED_NONSTD   1
+#define nsel_EXPECTED_STD      2
+
+#ifdef __has_include
+# if __has_include(<nonstd/expected.tweak.hpp>)
+#  include <nonstd/expected.tweak.hpp>
+# endif
+#endif
+
+#if !defined( nsel_CONFIG_SELECT_EXPECTED )
+# define nsel_CONFIG_SELECT_EXPECTED  ( nsel_HAVE_STD_EXPECTED ? nsel_EXPECTED_STD : nsel_EXPECTED_NONSTD )
+#endif
+
+#ifndef  nsel_P0323R
+# define nsel_P0323R  7
+#endif
+
+#ifndef   nsel_CPLUSPLUS
+# if defined(_MSVC_LANG ) && !defined(__clang__)
+#  define nsel_CPLUSPLUS  (_MSC_VER == 1900 ? 201103L : _MSVC_LANG )
+# else
+#  define nsel_CPLUSPLUS  __cplusplus
+# endif
+#endif
+
+#define nsel_CPP20_OR_GREATER  ( nsel_CPLUSPLUS >= 202000L )
+
+#if nsel_CPP20_OR_GREATER && defined(__has_include )
+# if __has_include( <version> )
+#  include <version>
+# endif
+#endif
+
+#if defined(__cpp_lib_expected) && __cpp_lib_expected >= 202211L
+# define  nsel_HAVE_STD_EXPECTED  1
+#else
+# define  nsel_HAVE_STD_EXPECTED  0
+#endif
+
+#define  nsel_USES_STD_EXPECTED  ( (nsel_CONFIG_SELECT_EXPECTED == nsel_EXPECTED_STD) || ((nsel_CONFIG_SELECT_EXPECTED == nsel_EXPECTED_DEFAULT) && nsel_HAVE_STD_EXPECTED) )
+
+#if nsel_USES_STD_EXPECTED
+
+// std::expected cannot be declared other than by its header:
+
+#include <expected>
+
+namespace nonstd {
+
+    using std::expected;
+    using std::unexpected;
+    using std::unexpect_t;
+    using std::unexpect;
+    using std::bad_expected_access;
+}
+
+#else // nsel_USES_STD_EXPECTED
+
+#if nsel_P0323R <= 2
+# include <exception>
+#endif
+
+namespace nonstd { namespace expected_lite {
+
+// the default error type of P0323R2 is only given here, see expected.hpp:
+
+#if nsel_P0323R <= 2
+template< typename T, typename E = std::exception_ptr >
+class expected;
+
+template< typename E = std::exception_ptr >
+class unexpected_type;
+#else
+template< typename T, typename E >
+class expected;
+
+template< typename E >
+class unexpected_type;
+#endif // nsel_P0323R
+
+template< typename E >
+class bad_expected_access;
+
+struct unexpect_t;
+
+} // namespace expected_lite
+
+using expected_lite::expected;
+using expected_lite::unexpected_type;
+using expected_lite::bad_expected_access;
+using expected_lite::unexpect_t;
+
+} // namespace nonstd
+
+#endif // nsel_USES_STD_EXPECTED
+
+#endif // NONSTD_EXPECTED_LITE_HPP
+
+#endif // NONSTD_EXPECTED_FWD_LITE_HPP
@@ -0,0 +1,257 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_parallel: transform a range into expected<U,E> on several threads.
+
+#ifndef NONSTD_EXPECTED_PARALLEL_LITE_HPP
+#define NONSTD_EXPECTED_PARALLEL_LITE_HPP
+
+#include "expected.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nonstd { namespace expected_lite {
+
+/// what parallel_transform_expected() does after an element yields an error.
+
+enum class parallel_mode
+{
+    all,            // transform every element
+    first_error     // stop claiming chunks once any element yields an error
+};
+
+/// options of parallel_transform_expected().
+
+struct parallel_options
+{
+    parallel_mode mode    = parallel_mode::first_error;
+    std::size_t   threads = 0;      // 0: std::thread::hardware_concurrency()
+    std::size_t   chunk   = 0;      // elements per claim; 0: choose from size and threads
+
+    parallel_options() = default;
+
+    parallel_options( parallel_mode mode_, std::size_t threads_ = 0, std::size_t chunk_ = 0 )
+        : mode( mode_ ), threads( threads_ ), chunk( chunk_ )
+    {}
+};
+
+namespace detail {
+
+/// state shared by the workers of one parallel_transform_expected() call.
+
+template< typename RandomIt, typename OutputIt, typename F >
+class parallel_transform
+{
+public:
+    parallel_transform( RandomIt first, OutputIt out, F & f, std::size_t size, std::size_t chunk, parallel_mode mode )
+        : m_first( first ), m_out( out ), m_f( f )
+        , m_size( size ), m_chunk( chunk ), m_mode( mode )
+        , m_next( 0 ), m_cancel( false ), m_first_error( size ), m_exception_taken( false )
+    {}
+
+    /// claim and transform chunks until none is left or the run is cancelled.
+
+    void run()
+    {
+#if nsel_CONFIG_NO_EXCEPTIONS
+        work();
+#else
+        try
+        {
+            work();
+        }
+        catch (...)
+        {
+            if ( ! m_exception_taken.exchange( true ) )
+                m_exception = std::current_exception();
+            m_cancel.store( true, std::memory_order_relaxed );
+        }
+#endif
+    }
+
+    /// stop claiming chunks.
+
+    void cancel() noexcept
+    {
+        m_cancel.store( true, std::memory_order_relaxed );
+    }
+
+    std::size_t first_error() const noexcept
+    {
+        return m_first_error.load();
+    }
+
+    std::exception_ptr exception() const
+    {
+        return m_exception;
+    }
+
+private:
+    void work()
+    {
+        for (;;)
+        {
+            if ( m_cancel.load( std::memory_order_relaxed ) )
+                return;
+
+            const std::size_t pos = m_next.fetch_add( m_chunk, std::memory_order_relaxed );
+
+            if ( pos >= m_size )
+                return;
+
+            const std::size_t end = (std::min)( pos + m_chunk, m_size );
+
+            for ( std::size_t i = pos; i != end; ++i )
+            {
+                using in_difference  = typename std::iterator_traits<RandomIt>::difference_type;
+                using out_difference = typename std::iterator_traits<OutputIt>::difference_type;
+
+                auto && result = m_out[ static_cast<out_difference>( i ) ] = m_f( m_first[ static_cast<in_difference>( i ) ] );
+
+                if ( ! result.has_value() )
+                    record_error( i );
+            }
+        }
+    }
+
+    // keep the lowest index; chunks are claimed in order, so every element
+    // before it has been transformed when the workers finish.
+
+    void record_error( std::size_t i ) noexcept
+    {
+        std::size_t current = m_first_error.load( std::memory_order_relaxed );
+
+        while ( i < current && ! m_first_error.compare_exchange_weak( current, i ) ) {}
+
+        if ( m_mode == parallel_mode::first_error )
+            m_cancel.store( true, std::memory_order_relaxed );
+    }
+
+private:
+    RandomIt    m_first;
+    OutputIt    m_out;
+    F &         m_f;
+    std::size_t m_size;
+    std::size_t m_chunk;
+    parallel_mode m_mode;
+
+    std::atomic<std::size_t> m_next;
+    std::atomic<bool>        m_cancel;
+    std::atomic<std::size_t> m_first_error;
+    std::atomic<bool>        m_exception_taken;
+    std::exception_ptr       m_exception;
+};
+
+/// threads that run job.run(); if not joined explicitly, e.g. as starting
+/// a thread failed, they are cancelled and joined on destruction, before
+/// the job they refer to goes away.
+
+template< typename Job >
+class worker_threads
+{
+public:
+    explicit worker_threads( Job & job ) noexcept
+        : m_job( job )
+    {}
+
+    worker_threads( worker_threads const & ) = delete;
+    worker_threads & operator=( worker_threads const & ) = delete;
+
+    ~worker_threads()
+    {
+        m_job.cancel();
+        join();
+    }
+
+    void start( std::size_t count )
+    {
+        m_threads.reserve( count );
+
+        for ( std::size_t i = 0; i != count; ++i )
+        {
+            m_threads.emplace_back( &Job::run, &m_job );
+        }
+    }
+
+    void join() noexcept
+    {
+        for ( auto & thread : m_threads )
+        {
+            if ( thread.joinable() )
+                thread.join();
+        }
+    }
+
+private:
+    Job &                    m_job;
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace detail
+
+/// assign f( first[i] ), an expected<U,E>, to out[i] for each element of
+/// [first, last), spreading chunks of elements over several threads.
+///
+/// Returns success if every element yields a value, otherwise the error of
+/// the lowest-indexed element that yields one. With parallel_mode::first_error,
+/// workers stop claiming chunks as soon as an error appears, leaving the
+/// output elements of unclaimed chunks untouched; those before the returned
+/// error are always assigned. An exception thrown by f cancels the run and
+/// is rethrown after all workers finish. f is called concurrently.
+
+template< typename RandomIt, typename OutputIt, typename F
+    , typename R = typename std::decay< decltype( std::declval<F &>()( *std::declval<RandomIt>() ) ) >::type
+    , typename E = typename R::error_type
+>
+expected<void, E> parallel_transform_expected( RandomIt first, RandomIt last, OutputIt out, F f, parallel_options options = parallel_options() )
+{
+    const std::size_t size = last < first ? 0 : static_cast<std::size_t>( last - first );
+
+    if ( size == 0 )
+        return expected<void, E>();
+
+    std::size_t threads = options.threads != 0 ? options.threads : std::thread::hardware_concurrency();
+    threads = (std::max)( std::size_t( 1 ), (std::min)( threads, size ) );
+
+    const std::size_t chunk = options.chunk != 0 ? options.chunk
+        : (std::max)( std::size_t( 1 ), size / ( 8 * threads ) );
+
+    using job_type = detail::parallel_transform<RandomIt, OutputIt, F>;
+
+    job_type job( first, out, f, size, chunk, options.mode );
+    detail::worker_threads<job_type> workers( job );
+
+    workers.start( threads - 1 );
+    job.run();
+    workers.join();
+
+#if !nsel_CONFIG_NO_EXCEPTIONS
+    if ( job.exception() )
+        std::rethrow_exception( job.exception() );
+#endif
+
+    const std::size_t pos = job.first_error();
+
+    if ( pos == size )
+        return expected<void, E>();
+
+    using difference_type = typename std::iterator_traits<OutputIt>::difference_type;
+
+    return make_unexpected( out[ static_cast<difference_type>( pos ) ].error() );
+}
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_PARALLEL_LITE_HPP
@@ -0,0 +1,422 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_pool: run functions on a work-stealing thread pool and receive
+// their result as expected via expected_future.
+
+#ifndef NONSTD_EXPECTED_POOL_LITE_HPP
+#define NONSTD_EXPECTED_POOL_LITE_HPP
+
+#include "expected.hpp"
+#include "expected_slot.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace nonstd { namespace expected_lite {
+
+namespace detail {
+
+/// unit of work of a work_stealing_pool.
+
+struct pool_task
+{
+    void (*execute)( pool_task * task );
+};
+
+template< typename R >
+struct is_expected_result : std::false_type {};
+
+template< typename T, typename E >
+struct is_expected_result< expected<T, E> > : std::true_type {};
+
+/// complete slot with the result of f( args... ): an expected as is, a
+/// value as value, and a void result as expected<void,E> with value.
+
+template< typename Slot, typename F, typename... Args >
+void call_into( Slot & slot, std::true_type /*expected*/, std::false_type /*void*/, F & f, Args&&... args )
+{
+    slot.set_result( f( std::forward<Args>( args )... ) );
+}
+
+template< typename Slot, typename F, typename... Args >
+void call_into( Slot & slot, std::false_type /*expected*/, std::true_type /*void*/, F & f, Args&&... args )
+{
+    f( std::forward<Args>( args )... );
+    slot.set_value();
+}
+
+template< typename Slot, typename F, typename... Args >
+void call_into( Slot & slot, std::false_type /*expected*/, std::false_type /*void*/, F & f, Args&&... args )
+{
+    slot.set_value( f( std::forward<Args>( args )... ) );
+}
+
+template< typename Slot >
+void set_current_exception( Slot & slot, std::true_type /*capture*/ )
+{
+    slot.set_error( std::current_exception() );
+}
+
+template< typename Slot >
+void set_current_exception( Slot &, std::false_type /*capture*/ )
+{
+    std::terminate();
+}
+
+/// same, capturing an exception thrown by f as error if the error type can
+/// hold a std::exception_ptr; otherwise the exception terminates the program.
+
+template< typename Slot, typename F, typename... Args >
+void run_into( Slot & slot, F & f, Args&&... args )
+{
+    using R = call_result<F, Args...>;
+
+#if nsel_CONFIG_NO_EXCEPTIONS
+    call_into( slot, is_expected_result<R>(), std::is_void<R>(), f, std::forward<Args>( args )... );
+#else
+    try
+    {
+        call_into( slot, is_expected_result<R>(), std::is_void<R>(), f, std::forward<Args>( args )... );
+    }
+    catch (...)
+    {
+        set_current_exception( slot, std::is_constructible< typename Slot::error_type, std::exception_ptr >() );
+    }
+#endif
+}
+
+/// task of async_expected(): runs f into its slot. Owned by its futures and,
+/// while queued, by itself.
+
+template< typename F, typename T, typename E >
+class async_task : public pool_task
+{
+public:
+    explicit async_task( F && f )
+        : pool_task{ &run }
+        , m_f( std::move( f ) )
+    {}
+
+    expected_slot<T, E>         slot;
+    std::shared_ptr<async_task> self;
+
+private:
+    static void run( pool_task * p )
+    {
+        async_task * task = static_cast<async_task *>( p );
+        std::shared_ptr<async_task> keep( std::move( task->self ) );
+
+        run_into( task->slot, task->m_f );
+    }
+
+    F m_f;
+};
+
+/// task of expected_future::then(): queued once the result of the previous
+/// future is present, then runs f( result ) into its slot.
+
+template< typename F, typename T0, typename E0, typename T, typename E >
+class then_task : public pool_task
+{
+public:
+    then_task( expected_future<T0, E0> const & previous, F && f, work_stealing_pool & pool )
+        : pool_task{ &run }
+        , m_previous( previous )
+        , m_f( std::move( f ) )
+        , m_pool( pool )
+    {}
+
+    void schedule_when_ready()
+    {
+        m_previous.on_ready( &ready, this );
+    }
+
+    expected_slot<T, E>        slot;
+    std::shared_ptr<then_task> self;
+
+private:
+    static void ready( expected_slot<T0, E0> &, void * context );
+
+    static void run( pool_task * p )
+    {
+        then_task * task = static_cast<then_task *>( p );
+        std::shared_ptr<then_task> keep( std::move( task->self ) );
+
+        run_into( task->slot, task->m_f, task->m_previous.get() );
+    }
+
+    expected_future<T0, E0> m_previous;
+    F                       m_f;
+    work_stealing_pool &    m_pool;
+};
+
+} // namespace detail
+
+/// class work_stealing_pool: worker threads that each own a deque of tasks.
+///
+/// A worker takes tasks from the back of its own deque and, when that is
+/// empty, steals from the front of the others. A task scheduled from a
+/// worker goes onto that worker's deque, so continuations tend to run where
+/// their input was produced; a task from another thread goes to the workers
+/// in turn. Idle workers sleep until work arrives. The destructor runs all
+/// queued tasks before it joins the workers.
+
+class work_stealing_pool
+{
+public:
+    /// start threads workers, or one per hardware thread if 0. If starting
+    /// one fails, those already started are stopped and joined.
+
+    explicit work_stealing_pool( std::size_t threads = 0 )
+        : m_queues( (std::max)( std::size_t( 1 ), threads != 0 ? threads : std::size_t( std::thread::hardware_concurrency() ) ) )
+        , m_next( 0 ), m_pending( 0 ), m_sleeping( 0 ), m_stop( false )
+    {
+        m_threads.reserve( m_queues.size() );
+
+#if ! nsel_CONFIG_NO_EXCEPTIONS
+        try
+#endif
+        {
+            for ( std::size_t i = 0; i != m_queues.size(); ++i )
+                m_threads.emplace_back( &work_stealing_pool::work, this, i );
+        }
+#if ! nsel_CONFIG_NO_EXCEPTIONS
+        catch (...)
+        {
+            stop();
+            throw;
+        }
+#endif
+    }
+
+    work_stealing_pool( work_stealing_pool const & ) = delete;
+    work_stealing_pool & operator=( work_stealing_pool const & ) = delete;
+
+    ~work_stealing_pool()
+    {
+        stop();
+    }
+
+    std::size_t size() const noexcept
+    {
+        return m_queues.size();
+    }
+
+    /// the pool of async_expected( f ), with one worker per hardware thread.
+
+    static work_stealing_pool & default_pool()
+    {
+        static work_stealing_pool pool;
+        return pool;
+    }
+
+    /// queue task, on the deque of the calling worker if it is one of ours;
+    /// that worker runs it next without waking others if its deque was empty.
+
+    void schedule( detail::pool_task * task )
+    {
+        worker_id const & self = current_worker();
+
+        const std::size_t index = self.pool == this
+            ? self.index
+            : m_next.fetch_add( 1, std::memory_order_relaxed ) % m_queues.size();
+
+        bool wake = true;
+
+        m_pending.fetch_add( 1 );
+        {
+            std::lock_guard<std::mutex> lock( m_queues[ index ].mutex );
+
+            wake = self.pool != this || ! m_queues[ index ].tasks.empty();
+            m_queues[ index ].tasks.push_back( task );
+        }
+
+        if ( wake && m_sleeping.load() != 0 )
+        {
+            std::lock_guard<std::mutex> lock( m_idle_mutex );
+            m_idle.notify_one();
+        }
+    }
+
+private:
+    // let the workers finish the queued tasks and leave, and join them.
+
+    void stop() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock( m_idle_mutex );
+            m_stop = true;
+        }
+        m_idle.notify_all();
+
+        for ( auto & thread : m_threads )
+            thread.join();
+    }
+
+    struct worker_queue
+    {
+        std::mutex                        mutex;
+        std::deque<detail::pool_task *>   tasks;
+    };
+
+    struct worker_id
+    {
+        work_stealing_pool * pool;
+        std::size_t          index;
+    };
+
+    static worker_id & current_worker() noexcept
+    {
+        static thread_local worker_id id = { nullptr, 0 };
+        return id;
+    }
+
+    void work( std::size_t index )
+    {
+        current_worker() = worker_id{ this, index };
+
+        for (;;)
+        {
+            if ( detail::pool_task * task = find_task( index ) )
+            {
+                m_pending.fetch_sub( 1 );
+                task->execute( task );
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock( m_idle_mutex );
+
+            m_sleeping.fetch_add( 1 );
+            m_idle.wait( lock, [this]{ return m_pending.load() != 0 || m_stop; } );
+            m_sleeping.fetch_sub( 1 );
+
+            if ( m_stop && m_pending.load() == 0 )
+                return;
+        }
+    }
+
+    detail::pool_task * find_task( std::size_t index )
+    {
+        {
+            worker_queue & own = m_queues[ index ];
+            std::lock_guard<std::mutex> lock( own.mutex );
+
+            if ( ! own.tasks.empty() )
+            {
+                detail::pool_task * task = own.tasks.back();
+                own.tasks.pop_back();
+                return task;
+            }
+        }
+
+        for ( std::size_t k = 1; k < m_queues.size(); ++k )
+        {
+            worker_queue & victim = m_queues[ ( index + k ) % m_queues.size() ];
+            std::lock_guard<std::mutex> lock( victim.mutex );
+
+            if ( ! victim.tasks.empty() )
+            {
+                detail::pool_task * task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    std::vector<worker_queue> m_queues;
+    std::vector<std::thread>  m_threads;
+    std::atomic<std::size_t>  m_next;
+    std::atomic<std::size_t>  m_pending;
+    std::atomic<std::size_t>  m_sleeping;
+    std::mutex                m_idle_mutex;
+    std::condition_variable   m_idle;
+    bool                      m_stop;
+};
+
+namespace detail {
+
+template< typename F, typename T0, typename E0, typename T, typename E >
+void then_task<F, T0, E0, T, E>::ready( expected_slot<T0, E0> &, void * context )
+{
+    then_task * task = static_cast<then_task *>( context );
+    task->m_pool.schedule( task );
+}
+
+} // namespace detail
+
+/// run f() on pool and yield a future of its result. A function returning
+/// expected<T,E> gives an expected_future<T,E>; one returning U gives an
+/// expected_future<U, std::exception_ptr>. An exception thrown by f becomes
+/// the error if the error type can hold a std::exception_ptr.
+///
+/// Waiting for a future on a worker of the same pool needs another worker
+/// to run the task; prefer then() there.
+
+template< typename F
+    , typename R = detail::call_result<F>
+    , typename Future = typename detail::future_of<R>::type
+>
+Future async_expected( work_stealing_pool & pool, F f )
+{
+    using task_type = detail::async_task< F, typename detail::future_of<R>::value_type, typename detail::future_of<R>::error_type >;
+
+    std::shared_ptr<task_type> task = std::make_shared<task_type>( std::move( f ) );
+    task->self = task;
+
+    auto & slot = task->slot;
+    pool.schedule( task.get() );
+
+    return Future( slot, std::move( task ), &pool );
+}
+
+/// run f() on the default pool.
+
+template< typename F
+    , typename R = detail::call_result<F>
+    , typename Future = typename detail::future_of<R>::type
+>
+Future async_expected( F f )
+{
+    return async_expected( work_stealing_pool::default_pool(), std::move( f ) );
+}
+
+template< typename T, typename E >
+template< typename F >
+auto expected_future<T, E>::then( F f ) -> typename detail::future_of< detail::call_result< F, expected<T, E> > >::type
+{
+    using R         = detail::call_result< F, expected<T, E> >;
+    using Future    = typename detail::future_of<R>::type;
+    using task_type = detail::then_task< F, T, E, typename detail::future_of<R>::value_type, typename detail::future_of<R>::error_type >;
+
+    assert( m_pool != nullptr && "then() requires a future from async_expected()" );
+
+    std::shared_ptr<task_type> task = std::make_shared<task_type>( *this, std::move( f ), *m_pool );
+    task->self = task;
+
+    auto & slot = task->slot;
+    task->schedule_when_ready();
+
+    return Future( slot, std::move( task ), m_pool );
+}
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_POOL_LITE_HPP
@@ -0,0 +1,364 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_queue: bounded lock-free multi-producer multi-consumer queue of
+// expected<T,E>.
+
+#ifndef NONSTD_EXPECTED_QUEUE_LITE_HPP
+#define NONSTD_EXPECTED_QUEUE_LITE_HPP
+
+#include "expected.hpp"
+#include "expected_vector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace nonstd { namespace expected_lite {
+
+/// class expected_queue: bounded ring of cells, each with a sequence number
+/// and the storage of an expected<T,E> (D. Vyukov's MPMC queue).
+///
+/// A producer claims the cell at the enqueue position if its sequence equals
+/// that position, constructs the value or error in it and then advances the
+/// sequence; a consumer does the reverse. Producers and consumers contend only
+/// on their own position. Capacity is rounded up to a power of two.
+///
+/// A claimed cell cannot be handed back, so nothing that may throw happens
+/// while a producer holds one: an element that cannot be constructed in place
+/// without throwing is constructed before the claim and moved into the cell,
+/// which requires T and E to be nothrow move-constructible.
+
+template< typename T, typename E >
+class expected_queue
+{
+    static_assert( ! std::is_void<T>::value, "expected_queue<T,E> requires a non-void T" );
+    static_assert( std::is_nothrow_move_constructible<T>::value, "expected_queue<T,E> requires a nothrow move-constructible T" );
+    static_assert( detail::is_nothrow_error_move_constructible<E>::value, "expected_queue<T,E> requires a nothrow move-constructible E that is not boxed" );
+
+public:
+    using value_type = expected<T, E>;
+    using size_type  = std::size_t;
+
+    explicit expected_queue( size_type capacity )
+        : m_mask( round_up( capacity ) - 1 )
+        , m_cells( new cell[ m_mask + 1 ] )
+        , m_enqueue( 0 ), m_dequeue( 0 ), m_errors( 0 )
+    {
+        for ( size_type i = 0; i <= m_mask; ++i )
+            m_cells[i].sequence.store( i, std::memory_order_relaxed );
+    }
+
+    expected_queue( expected_queue const & ) = delete;
+    expected_queue & operator=( expected_queue const & ) = delete;
+
+    ~expected_queue()
+    {
+        size_type pos = 0;
+
+        while ( claim_dequeue( pos, 1 ) )
+            release( cell_at( pos ), pos );
+    }
+
+    size_type capacity() const noexcept
+    {
+        return m_mask + 1;
+    }
+
+    /// number of elements, exact only if no producer or consumer is active.
+
+    size_type size_approx() const noexcept
+    {
+        const size_type dequeued = m_dequeue.load( std::memory_order_relaxed );
+        const size_type enqueued = m_enqueue.load( std::memory_order_relaxed );
+
+        return enqueued > dequeued ? enqueued - dequeued : 0;
+    }
+
+    /// number of elements ever enqueued, and of errors among them.
+
+    std::uint64_t enqueued_count() const noexcept
+    {
+        return m_enqueue.load( std::memory_order_relaxed );
+    }
+
+    std::uint64_t error_count() const noexcept
+    {
+        return m_errors.load( std::memory_order_relaxed );
+    }
+
+    // producers; an element that must be constructed before the claim
+    // consumes rvalue arguments also when the queue is full:
+
+    template< typename... Args >
+    bool try_emplace( Args&&... args )
+    {
+        return try_construct( value_tag(), std::is_nothrow_constructible<T, Args&&...>(), std::forward<Args>( args )... );
+    }
+
+    template< typename... Args >
+    bool try_emplace_error( Args&&... args )
+    {
+        return try_construct( error_tag(), std::is_nothrow_constructible<E, Args&&...>(), std::forward<Args>( args )... );
+    }
+
+    bool try_push( value_type const & e )
+    {
+        return e.has_value() ? try_emplace( *e ) : try_emplace_error( e.error() );
+    }
+
+    bool try_push( value_type && e )
+    {
+        return e.has_value() ? try_emplace( std::move( *e ) ) : try_emplace_error( std::move( e.error() ) );
+    }
+
+    /// same as try_emplace(), try_emplace_error() and try_push(), but yield
+    /// while the queue is full. Arguments are consumed only once there is room.
+
+    template< typename... Args >
+    void emplace( Args&&... args )
+    {
+        construct( value_tag(), std::is_nothrow_constructible<T, Args&&...>(), std::forward<Args>( args )... );
+    }
+
+    template< typename... Args >
+    void emplace_error( Args&&... args )
+    {
+        construct( error_tag(), std::is_nothrow_constructible<E, Args&&...>(), std::forward<Args>( args )... );
+    }
+
+    template< typename X >
+    void push( X && e )
+    {
+        while ( ! try_push( std::forward<X>( e ) ) )
+            std::this_thread::yield();
+    }
+
+    // consumers:
+
+    bool try_pop( value_type & out )
+    {
+        size_type pos = 0;
+
+        if ( 0 == claim_dequeue( pos, 1 ) )
+            return false;
+
+        out = take( cell_at( pos ), pos );
+        return true;
+    }
+
+    /// move up to n elements to the end of out, claiming all available ones,
+    /// up to n, with a single compare-and-swap; returns the number moved.
+    /// If appending to out throws, the elements not yet moved are dropped.
+
+    size_type try_pop_n( expected_vector<T, E> & out, size_type n )
+    {
+        out.reserve( out.size() + (std::min)( n, capacity() ) );
+
+        size_type pos = 0;
+        size_type i   = 0;
+        const size_type count = claim_dequeue( pos, n );
+
+#if ! nsel_CONFIG_NO_EXCEPTIONS
+        try
+#endif
+        {
+            for ( ; i != count; ++i )
+            {
+                cell & c = cell_at( pos + i );
+
+                if ( c.contained.has_value() ) out.emplace_back( std::move( c.contained.value() ) );
+                else                           out.emplace_error( std::move( c.contained.error() ) );
+
+                release( c, pos + i );
+            }
+        }
+#if ! nsel_CONFIG_NO_EXCEPTIONS
+        catch (...)
+        {
+            for ( ; i != count; ++i )
+                release( cell_at( pos + i ), pos + i );
+            throw;
+        }
+#endif
+        return count;
+    }
+
+private:
+    using value_tag = std::true_type;
+    using error_tag = std::false_type;
+    struct cell
+    {
+        std::atomic<size_type>       sequence;
+        detail::storage_t_impl<T, E> contained;
+    };
+
+    // construct in place if that cannot throw, otherwise into a temporary
+    // that is moved into the cell:
+
+    template< typename Tag, typename... Args >
+    bool try_construct( Tag, std::true_type /*nothrow*/, Args&&... args )
+    {
+        cell * c = claim_enqueue();
+
+        if ( ! c )
+            return false;
+
+        construct_in( Tag(), c->contained, std::forward<Args>( args )... );
+        publish_enqueue( c );
+        return true;
+    }
+
+    template< typename Tag, typename... Args >
+    bool try_construct( Tag, std::false_type /*nothrow*/, Args&&... args )
+    {
+        typename std::conditional< Tag::value, T, E >::type x( std::forward<Args>( args )... );
+        return try_construct( Tag(), std::true_type(), std::move( x ) );
+    }
+
+    template< typename Tag, typename... Args >
+    void construct( Tag, std::true_type /*nothrow*/, Args&&... args )
+    {
+        while ( ! try_construct( Tag(), std::true_type(), std::forward<Args>( args )... ) )
+            std::this_thread::yield();
+    }
+
+    template< typename Tag, typename... Args >
+    void construct( Tag, std::false_type /*nothrow*/, Args&&... args )
+    {
+        typename std::conditional< Tag::value, T, E >::type x( std::forward<Args>( args )... );
+        construct( Tag(), std::true_type(), std::move( x ) );
+    }
+
+    template< typename... Args >
+    void construct_in( value_tag, detail::storage_t_impl<T, E> & contained, Args&&... args ) noexcept
+    {
+        contained.emplace_value( std::forward<Args>( args )... );
+        contained.set_has_value( true );
+    }
+
+    template< typename... Args >
+    void construct_in( error_tag, detail::storage_t_impl<T, E> & contained, Args&&... args ) noexcept
+    {
+        contained.emplace_error( std::forward<Args>( args )... );
+        contained.set_has_value( false );
+        m_errors.fetch_add( 1, std::memory_order_relaxed );
+    }
+
+    static size_type round_up( size_type n ) noexcept
+    {
+        size_type r = 2;
+        while ( r < n ) r *= 2;
+        return r;
+    }
+
+    // signed difference of sequence numbers, which may wrap around.
+
+    static std::ptrdiff_t distance( size_type seq, size_type pos ) noexcept
+    {
+        return static_cast<std::ptrdiff_t>( seq - pos );
+    }
+
+    cell & cell_at( size_type pos ) const noexcept
+    {
+        return m_cells[ pos & m_mask ];
+    }
+
+    cell * claim_enqueue() noexcept
+    {
+        size_type pos = m_enqueue.load( std::memory_order_relaxed );
+
+        for (;;)
+        {
+            cell & c = cell_at( pos );
+            const std::ptrdiff_t dif = distance( c.sequence.load( std::memory_order_acquire ), pos );
+
+            if ( dif == 0 )
+            {
+                if ( m_enqueue.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+                    return &c;
+            }
+            else if ( dif < 0 )
+            {
+                return nullptr;     // full
+            }
+            else
+            {
+                pos = m_enqueue.load( std::memory_order_relaxed );
+            }
+        }
+    }
+
+    void publish_enqueue( cell * c ) noexcept
+    {
+        const size_type pos = c->sequence.load( std::memory_order_relaxed );
+        c->sequence.store( pos + 1, std::memory_order_release );
+    }
+
+    // claim up to n consecutive filled cells from pos on; 0 if none.
+
+    size_type claim_dequeue( size_type & pos, size_type n ) noexcept
+    {
+        pos = m_dequeue.load( std::memory_order_relaxed );
+
+        for (;;)
+        {
+            size_type count = 0;
+
+            while ( count != n && cell_at( pos + count ).sequence.load( std::memory_order_acquire ) == pos + count + 1 )
+                ++count;
+
+            if ( count == 0 )
+            {
+                if ( distance( cell_at( pos ).sequence.load( std::memory_order_acquire ), pos + 1 ) < 0 )
+                    return 0;       // empty
+
+                pos = m_dequeue.load( std::memory_order_relaxed );
+                continue;
+            }
+
+            if ( m_dequeue.compare_exchange_weak( pos, pos + count, std::memory_order_relaxed ) )
+                return count;
+        }
+    }
+
+    value_type take( cell & c, size_type pos )
+    {
+        value_type result = c.contained.has_value()
+            ? value_type( std::move( c.contained.value() ) )
+            : value_type( unexpect, std::move( c.contained.error() ) );
+
+        release( c, pos );
+        return result;
+    }
+
+    void release( cell & c, size_type pos ) noexcept
+    {
+        if ( c.contained.has_value() ) c.contained.destruct_value();
+        else                           c.contained.destruct_error();
+
+        c.sequence.store( pos + m_mask + 1, std::memory_order_release );
+    }
+
+private:
+    enum { cache_line = 64 };
+
+    const size_type                               m_mask;
+    std::unique_ptr<cell[]>                       m_cells;
+    alignas(cache_line) std::atomic<size_type>     m_enqueue;
+    alignas(cache_line) std::atomic<size_type>     m_dequeue;
+    alignas(cache_line) std::atomic<std::uint64_t> m_errors;
+};
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_QUEUE_LITE_HPP
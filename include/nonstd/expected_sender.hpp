@@ -0,0 +1,450 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_sender: adapters between expected<T,E> and senders and receivers
+// in the style of P2300, without type erasure or allocation.
+
+#ifndef NONSTD_EXPECTED_SENDER_LITE_HPP
+#define NONSTD_EXPECTED_SENDER_LITE_HPP
+
+#include "expected.hpp"
+#include "expected_slot.hpp"
+
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+// The adapters use the member protocol of P2300:
+//
+// - a receiver r completes via std::move( r ).set_value( args... ),
+//   set_error( error ) or set_stopped();
+// - a sender s is connected to a receiver via std::move( s ).connect( r ),
+//   which yields an operation state op, started via op.start();
+// - a sender describes its completions via the member templates
+//   value_types<Tuple, Variant> and error_types<Variant>, and the constant
+//   sends_stopped.
+
+namespace nonstd { namespace expected_lite {
+
+/// error that an expected_receiver passes on for set_stopped(), if its
+/// error type is constructible from it.
+
+struct sender_stopped {};
+
+namespace detail {
+
+/// T for a value completion with a single argument, void for one without.
+
+template< typename... Ts >
+struct single_value;
+
+template<>
+struct single_value<>
+{
+    using type = void;
+};
+
+template< typename T >
+struct single_value<T>
+{
+    using type = T;
+};
+
+template< typename... Ts >
+using single_value_t = typename single_value<Ts...>::type;
+
+/// the single alternative of a list of completions.
+
+template< typename... Ts >
+struct single_type;
+
+template< typename T >
+struct single_type<T>
+{
+    using type = T;
+};
+
+template< typename... Ts >
+using single_type_t = typename single_type<Ts...>::type;
+
+/// expected<T,E> for a sender that completes with set_value( T ) or set_error( E ).
+
+template< typename S >
+struct sender_expected
+{
+    using sender     = typename std::decay<S>::type;
+    using value_type = typename sender::template value_types< single_value_t, single_type_t >;
+    using error_type = typename sender::template error_types< single_type_t >;
+    using type       = expected< value_type, error_type >;
+};
+
+/// whether T is among Ts.
+
+template< typename T, typename... Ts >
+struct contains : std::false_type {};
+
+template< typename T, typename U, typename... Ts >
+struct contains< T, U, Ts... > : std::integral_constant< bool, std::is_same<T, U>::value || contains<T, Ts...>::value > {};
+
+/// Tuple<T> for the value T of a sender, Tuple<> for void.
+
+template< typename T, template< typename... > class Tuple >
+struct value_tuple
+{
+    using type = Tuple<T>;
+};
+
+template< template< typename... > class Tuple >
+struct value_tuple< void, Tuple >
+{
+    using type = Tuple<>;
+};
+
+/// Variant< Es..., G > for the error types Es of sender S, or Variant< Es... >
+/// if G is among them.
+
+template< template< typename... > class Variant, typename G, bool Present, typename... Es >
+struct add_error
+{
+    using type = Variant< Es... >;
+};
+
+template< template< typename... > class Variant, typename G, typename... Es >
+struct add_error< Variant, G, false, Es... >
+{
+    using type = Variant< Es..., G >;
+};
+
+template< typename S, typename G, template< typename... > class Variant >
+struct append_error
+{
+    template< typename... Es >
+    using apply = typename add_error< Variant, G, contains<G, Es...>::value, Es... >::type;
+
+    using type = typename S::template error_types< apply >;
+};
+
+/// whether receiver R accepts the value T, or nothing for void T, and the
+/// error E without throwing.
+
+template< typename R, typename T, typename E >
+struct is_nothrow_receiver_of : std::integral_constant< bool,
+    noexcept( std::declval<R>().set_value( std::declval<T>() ) ) &&
+    noexcept( std::declval<R>().set_error( std::declval<E>() ) ) > {};
+
+template< typename R, typename E >
+struct is_nothrow_receiver_of< R, void, E > : std::integral_constant< bool,
+    noexcept( std::declval<R>().set_value() ) &&
+    noexcept( std::declval<R>().set_error( std::declval<E>() ) ) > {};
+
+template< typename R, typename T, typename E >
+void complete_with( R & r, expected<T, E> && e, std::false_type /*void*/ )
+    noexcept( is_nothrow_receiver_of<R, T, E>::value )
+{
+    if ( e.has_value() ) std::move( r ).set_value( std::move( *e ) );
+    else                 std::move( r ).set_error( std::move( e ).error() );
+}
+
+template< typename R, typename T, typename E >
+void complete_with( R & r, expected<T, E> && e, std::true_type /*void*/ )
+    noexcept( is_nothrow_receiver_of<R, void, E>::value )
+{
+    if ( e.has_value() ) std::move( r ).set_value();
+    else                 std::move( r ).set_error( std::move( e ).error() );
+}
+
+/// whether U constructs from Args without throwing; void from nothing does.
+
+template< typename U, typename... Args >
+struct is_nothrow_payload : std::is_nothrow_constructible<U, Args...> {};
+
+template<>
+struct is_nothrow_payload<void> : std::true_type {};
+
+/// whether an expected_receiver into expected<T,E> completes without throwing:
+/// its payload constructs without throwing, or E can hold the exception.
+
+template< typename E, typename U, typename... Args >
+struct is_nothrow_completion : std::integral_constant< bool,
+    is_nothrow_payload<U, Args...>::value || std::is_constructible<E, std::exception_ptr>::value > {};
+
+} // namespace detail
+
+// -----------------------------------------------------------------------
+// expected as sender
+
+/// operation state of an expected_sender connected to receiver R; start()
+/// is noexcept if R accepts the value and the error without throwing.
+
+template< typename T, typename E, typename R >
+class expected_operation
+{
+public:
+    expected_operation( expected<T, E> && e, R && r )
+        : m_result( std::move( e ) )
+        , m_receiver( std::move( r ) )
+    {}
+
+    void start() noexcept( detail::is_nothrow_receiver_of<R, T, E>::value )
+    {
+        detail::complete_with( m_receiver, std::move( m_result ), std::is_void<T>() );
+    }
+
+private:
+    expected<T, E> m_result;
+    R              m_receiver;
+};
+
+/// sender that completes at once with set_value( T ), or set_value() for
+/// void T, if it holds a value, and with set_error( E ) otherwise.
+
+template< typename T, typename E >
+class expected_sender
+{
+public:
+    template< template< typename... > class Tuple, template< typename... > class Variant >
+    using value_types = Variant< typename detail::value_tuple<T, Tuple>::type >;
+
+    template< template< typename... > class Variant >
+    using error_types = Variant<E>;
+
+    static constexpr bool sends_stopped = false;
+
+    explicit expected_sender( expected<T, E> const & e )
+        : m_result( e )
+    {}
+
+    explicit expected_sender( expected<T, E> && e )
+        : m_result( std::move( e ) )
+    {}
+
+    template< typename R >
+    expected_operation<T, E, typename std::decay<R>::type> connect( R && r ) &&
+    {
+        return expected_operation<T, E, typename std::decay<R>::type>( std::move( m_result ), std::forward<R>( r ) );
+    }
+
+    template< typename R >
+    expected_operation<T, E, typename std::decay<R>::type> connect( R && r ) const &
+    {
+        return expected_operation<T, E, typename std::decay<R>::type>( expected<T, E>( m_result ), std::forward<R>( r ) );
+    }
+
+private:
+    expected<T, E> m_result;
+};
+
+template< typename T, typename E >
+constexpr bool expected_sender<T, E>::sends_stopped;
+
+/// sender of the value or error of e.
+
+template< typename T, typename E >
+expected_sender<T, E> as_sender( expected<T, E> const & e )
+{
+    return expected_sender<T, E>( e );
+}
+
+template< typename T, typename E >
+expected_sender<T, E> as_sender( expected<T, E> && e )
+{
+    return expected_sender<T, E>( std::move( e ) );
+}
+
+// -----------------------------------------------------------------------
+// completion into expected
+
+/// receiver that hands the completion of a sender to an expected_slot: the
+/// value of set_value() or the error of set_error(). It accepts set_stopped()
+/// only if E is constructible from sender_stopped.
+///
+/// If constructing the value or error throws, the exception becomes the
+/// error if E is constructible from std::exception_ptr; otherwise the
+/// completion is only noexcept if that construction is.
+
+template< typename T, typename E >
+class expected_receiver
+{
+public:
+    explicit expected_receiver( expected_slot<T, E> & slot ) noexcept
+        : m_slot( &slot )
+    {}
+
+    template< typename... Args >
+    void set_value( Args&&... args ) noexcept( detail::is_nothrow_completion<E, T, Args&&...>::value )
+    {
+        complete( std::is_constructible<E, std::exception_ptr>(), [&]{ m_slot->set_value( std::forward<Args>( args )... ); } );
+    }
+
+    template< typename G >
+    void set_error( G && error ) noexcept( detail::is_nothrow_completion<E, E, G&&>::value )
+    {
+        complete( std::is_constructible<E, std::exception_ptr>(), [&]{ m_slot->set_error( std::forward<G>( error ) ); } );
+    }
+
+    template< typename G = E
+        , typename = typename std::enable_if< std::is_constructible<G, sender_stopped>::value >::type
+    >
+    void set_stopped() noexcept
+    {
+        m_slot->set_error( sender_stopped() );
+    }
+
+private:
+    template< typename F >
+    void complete( std::false_type /*capture*/, F && f )
+    {
+        f();
+    }
+
+    template< typename F >
+    void complete( std::true_type /*capture*/, F && f ) noexcept
+    {
+#if nsel_CONFIG_NO_EXCEPTIONS
+        f();
+#else
+        try
+        {
+            f();
+        }
+        catch (...)
+        {
+            m_slot->set_error( std::current_exception() );
+        }
+#endif
+    }
+
+private:
+    expected_slot<T, E> * m_slot;
+};
+
+/// connect sender s to a receiver into a slot on the stack, start it and
+/// wait for its completion, as expected<T,E>. T and E follow from the value
+/// and error types of s if each has a single alternative.
+///
+/// The slot and the operation state go away on return. This is safe as the
+/// slot's final store of its ready state is the completing thread's last
+/// access of it, and, as P2300 requires, a sender does not access its
+/// operation state once it has invoked the completion of its receiver.
+
+template< typename T, typename E, typename S >
+expected<T, E> sync_wait_expected( S && s )
+{
+    expected_slot<T, E> slot;
+
+    auto op = std::forward<S>( s ).connect( expected_receiver<T, E>( slot ) );
+    op.start();
+
+    return slot.get();
+}
+
+template< typename S
+    , typename Result = typename detail::sender_expected<S>::type
+>
+Result sync_wait_expected( S && s )
+{
+    return sync_wait_expected< typename Result::value_type, typename Result::error_type >( std::forward<S>( s ) );
+}
+
+// -----------------------------------------------------------------------
+// expected-returning function as sender adapter
+
+/// receiver that calls f( args... ) for set_value( args... ) and completes
+/// receiver R with the value or error of the expected that f returns; other
+/// completions pass through. Its completions are noexcept if f and those of
+/// R that they invoke are; otherwise an exception propagates to the caller.
+
+template< typename F, typename R >
+class expected_transform_receiver
+{
+public:
+    expected_transform_receiver( F && f, R && r )
+        : m_f( std::move( f ) )
+        , m_receiver( std::move( r ) )
+    {}
+
+    template< typename... Args
+        , typename result = detail::call_result<F, Args...>
+    >
+    void set_value( Args&&... args ) noexcept(
+        noexcept( std::declval<F &>()( std::declval<Args>()... ) ) &&
+        detail::is_nothrow_receiver_of<R, typename result::value_type, typename result::error_type>::value )
+    {
+        detail::complete_with( m_receiver, m_f( std::forward<Args>( args )... ), std::is_void< typename result::value_type >() );
+    }
+
+    template< typename G >
+    void set_error( G && error ) noexcept( noexcept( std::declval<R>().set_error( std::declval<G>() ) ) )
+    {
+        std::move( m_receiver ).set_error( std::forward<G>( error ) );
+    }
+
+    template< typename Q = R >
+    auto set_stopped() noexcept -> decltype( std::declval<Q>().set_stopped() )
+    {
+        std::move( m_receiver ).set_stopped();
+    }
+
+private:
+    F m_f;
+    R m_receiver;
+};
+
+/// sender that completes with the value or error of the expected<U,G> that
+/// f returns for the value of sender S, or with the error of S.
+
+template< typename S, typename F >
+class expected_transform_sender
+{
+    template< typename... Ts >
+    using result_of = detail::call_result<F, Ts...>;
+
+    using result = typename S::template value_types< result_of, detail::single_type_t >;
+
+public:
+    template< template< typename... > class Tuple, template< typename... > class Variant >
+    using value_types = typename expected_sender< typename result::value_type, typename result::error_type >::template value_types<Tuple, Variant>;
+
+    template< template< typename... > class Variant >
+    using error_types = typename detail::append_error< S, typename result::error_type, Variant >::type;
+
+    static constexpr bool sends_stopped = S::sends_stopped;
+
+    template< typename S2 >
+    expected_transform_sender( S2 && s, F f )
+        : m_sender( std::forward<S2>( s ) )
+        , m_f( std::move( f ) )
+    {}
+
+    template< typename R >
+    auto connect( R && r ) &&
+        -> decltype( std::declval<S>().connect( std::declval< expected_transform_receiver< F, typename std::decay<R>::type > >() ) )
+    {
+        return std::move( m_sender ).connect(
+            expected_transform_receiver< F, typename std::decay<R>::type >( std::move( m_f ), std::forward<R>( r ) ) );
+    }
+
+private:
+    S m_sender;
+    F m_f;
+};
+
+template< typename S, typename F >
+constexpr bool expected_transform_sender<S, F>::sends_stopped;
+
+/// sender that passes the value of s to f, which returns an expected, and
+/// completes with its value or error; an error of s passes through.
+
+template< typename S, typename F >
+expected_transform_sender< typename std::decay<S>::type, F > transform_expected( S && s, F f )
+{
+    return expected_transform_sender< typename std::decay<S>::type, F >( std::forward<S>( s ), std::move( f ) );
+}
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_SENDER_LITE_HPP
@@ -0,0 +1,738 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_simd: batch kernels over a validity bitmap and a value array,
+// such as held by expected_vector<T,E>, with runtime CPU dispatch.
+
+#ifndef NONSTD_EXPECTED_SIMD_LITE_HPP
+#define NONSTD_EXPECTED_SIMD_LITE_HPP
+
+#include "expected_vector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Control use of SSE4.2 and AVX2 kernels (0: use them when the CPU supports them):
+
+#ifndef  nsel_CONFIG_NO_SIMD
+# define nsel_CONFIG_NO_SIMD  0
+#endif
+
+#if !nsel_CONFIG_NO_SIMD && ( defined(__x86_64__) || defined(_M_X64) ) && ( defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER) )
+# define nsel_HAVE_X86_SIMD  1
+#else
+# define nsel_HAVE_X86_SIMD  0
+#endif
+
+#if nsel_HAVE_X86_SIMD
+# include <immintrin.h>
+# if defined(_MSC_VER) && !defined(__clang__)
+#  include <intrin.h>
+#  define nsel_TARGET_SSE42
+#  define nsel_TARGET_AVX2
+# else
+#  define nsel_TARGET_SSE42  __attribute__(( target("sse4.2,popcnt") ))
+#  define nsel_TARGET_AVX2   __attribute__(( target("avx2,popcnt") ))
+# endif
+#endif
+
+namespace nonstd { namespace expected_lite {
+
+/// instruction set used by the batch kernels.
+
+enum class simd_level
+{
+    scalar,
+    sse42,
+    avx2
+};
+
+namespace simd {
+
+using word_type = std::uint64_t;
+
+enum { word_bits = 64 };
+
+/// values that the vector kernels move as 4- or 8-byte lanes.
+
+template< typename T >
+struct has_vector_lanes : std::integral_constant< bool,
+    std::is_scalar<T>::value && ( sizeof(T) == 4 || sizeof(T) == 8 ) > {};
+
+inline std::size_t word_count( std::size_t n ) noexcept
+{
+    return ( n + word_bits - 1 ) / word_bits;
+}
+
+/// bits of word k that correspond to elements below n.
+
+inline word_type word_mask( std::size_t k, std::size_t n ) noexcept
+{
+    return ( k + 1 ) * word_bits <= n ? ~word_type( 0 ) : ( word_type( 1 ) << ( n % word_bits ) ) - 1;
+}
+
+inline unsigned count_trailing_zeros( word_type w ) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<unsigned>( __builtin_ctzll( w ) );
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long pos;
+    return _BitScanForward64( &pos, w ), static_cast<unsigned>( pos );
+#else
+    unsigned pos = 0;
+    for ( ; ( w & 1u ) == 0; w >>= 1 ) ++pos;
+    return pos;
+#endif
+}
+
+// portable kernels:
+
+namespace scalar {
+
+inline std::size_t popcount( word_type w ) noexcept
+{
+    w = w - ( ( w >> 1 ) & 0x5555555555555555ULL );
+    w = ( w & 0x3333333333333333ULL ) + ( ( w >> 2 ) & 0x3333333333333333ULL );
+    w = ( w + ( w >> 4 ) ) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<std::size_t>( ( w * 0x0101010101010101ULL ) >> 56 );
+}
+
+inline std::size_t count_errors( word_type const * bits, std::size_t n ) noexcept
+{
+    std::size_t values = 0;
+
+    for ( std::size_t k = 0, nw = word_count( n ); k != nw; ++k )
+    {
+        values += popcount( bits[k] & word_mask( k, n ) );
+    }
+    return n - values;
+}
+
+inline std::size_t first_error( word_type const * bits, std::size_t n, std::size_t k = 0 ) noexcept
+{
+    for ( std::size_t nw = word_count( n ); k != nw; ++k )
+    {
+        if ( const word_type e = ~bits[k] & word_mask( k, n ) )
+        {
+            return k * word_bits + count_trailing_zeros( e );
+        }
+    }
+    return n;
+}
+
+template< typename T, typename U >
+std::size_t compact_values( word_type const * bits, T const * values, std::size_t n, U * out, std::size_t k = 0, std::size_t m = 0 )
+{
+    for ( std::size_t nw = word_count( n ); k != nw; ++k )
+    {
+        word_type w = bits[k] & word_mask( k, n );
+        T const * block = values + k * word_bits;
+
+        if ( w == ~word_type( 0 ) )
+        {
+            out = std::copy( block, block + word_bits, out );
+            m  += word_bits;
+            continue;
+        }
+        for ( ; w != 0; w &= w - 1, ++m )
+        {
+            *out++ = block[ count_trailing_zeros( w ) ];
+        }
+    }
+    return m;
+}
+
+template< typename T >
+void value_or_fill( word_type const * bits, T * values, std::size_t n, T const & v, std::size_t k = 0 )
+{
+    for ( std::size_t nw = word_count( n ); k != nw; ++k )
+    {
+        T * block = values + k * word_bits;
+
+        for ( word_type e = ~bits[k] & word_mask( k, n ); e != 0; e &= e - 1 )
+        {
+            block[ count_trailing_zeros( e ) ] = v;
+        }
+    }
+}
+
+} // namespace scalar
+
+#if nsel_HAVE_X86_SIMD
+
+// SSE4.2 kernels: hardware popcount, two words per comparison, shuffle-based
+// compaction, blend fill:
+
+namespace sse42 {
+
+/// byte shuffles that pack the selected elements to the front.
+
+struct compact_table
+{
+    std::uint8_t lanes4[16][16];    // 4 elements of 4 bytes, indexed by 4 presence bits
+    std::uint8_t lanes8[ 4][16];    // 2 elements of 8 bytes, indexed by 2 presence bits
+
+    compact_table()
+    {
+        fill( lanes4, 4 );
+        fill( lanes8, 8 );
+    }
+
+    static compact_table const & instance()
+    {
+        static const compact_table table;
+        return table;
+    }
+
+private:
+    template< std::size_t N >
+    static void fill( std::uint8_t (&table)[N][16], unsigned size )
+    {
+        for ( unsigned mask = 0; mask != N; ++mask )
+        {
+            unsigned m = 0;
+            for ( unsigned i = 0; i != 16 / size; ++i )
+                if ( mask & ( 1u << i ) )
+                    for ( unsigned b = 0; b != size; ++b ) { table[mask][m++] = static_cast<std::uint8_t>( i * size + b ); }
+            for ( ; m != 16; ++m )
+                table[mask][m] = 0;
+        }
+    }
+};
+
+/// 128-bit operations on lanes of Size bytes.
+
+template< std::size_t Size >
+struct lanes;
+
+template<>
+struct lanes<4>
+{
+    enum { count = 4 };
+
+    nsel_TARGET_SSE42
+    static __m128i splat( void const * v ) noexcept
+    {
+        std::int32_t x; std::memcpy( &x, v, sizeof x ); return _mm_set1_epi32( x );
+    }
+
+    nsel_TARGET_SSE42
+    static __m128i select( unsigned mask ) noexcept
+    {
+        const __m128i sel = _mm_setr_epi32( 1, 2, 4, 8 );
+        return _mm_cmpeq_epi32( _mm_and_si128( _mm_set1_epi32( static_cast<int>( mask ) ), sel ), sel );
+    }
+
+    static std::uint8_t const * permutation( unsigned mask ) noexcept
+    {
+        return compact_table::instance().lanes4[ mask ];
+    }
+};
+
+template<>
+struct lanes<8>
+{
+    enum { count = 2 };
+
+    nsel_TARGET_SSE42
+    static __m128i splat( void const * v ) noexcept
+    {
+        std::int64_t x; std::memcpy( &x, v, sizeof x ); return _mm_set1_epi64x( x );
+    }
+
+    nsel_TARGET_SSE42
+    static __m128i select( unsigned mask ) noexcept
+    {
+        const __m128i sel = _mm_set_epi64x( 2, 1 );
+        return _mm_cmpeq_epi64( _mm_and_si128( _mm_set1_epi64x( mask ), sel ), sel );
+    }
+
+    static std::uint8_t const * permutation( unsigned mask ) noexcept
+    {
+        return compact_table::instance().lanes8[ mask ];
+    }
+};
+
+/// presence bits of the lanes elements starting at pos.
+
+inline unsigned lane_bits( word_type const * bits, std::size_t pos, std::size_t lanes ) noexcept
+{
+    return static_cast<unsigned>( bits[ pos / word_bits ] >> ( pos % word_bits ) ) & ( ( 1u << lanes ) - 1 );
+}
+
+template< typename T >
+void value_or_fill_tail( word_type const * bits, T * values, std::size_t n, T const & v, std::size_t pos )
+{
+    for ( ; pos != n; ++pos )
+    {
+        if ( ! ( ( bits[ pos / word_bits ] >> ( pos % word_bits ) ) & 1u ) )
+            values[ pos ] = v;
+    }
+}
+
+nsel_TARGET_SSE42
+inline std::size_t count_errors( word_type const * bits, std::size_t n ) noexcept
+{
+    std::size_t values = 0;
+
+    for ( std::size_t k = 0, nw = word_count( n ); k != nw; ++k )
+    {
+        values += static_cast<std::size_t>( _mm_popcnt_u64( bits[k] & word_mask( k, n ) ) );
+    }
+    return n - values;
+}
+
+nsel_TARGET_SSE42
+inline std::size_t first_error( word_type const * bits, std::size_t n ) noexcept
+{
+    const std::size_t full = n / word_bits;
+    const __m128i ones = _mm_set1_epi64x( -1 );
+
+    std::size_t k = 0;
+    for ( ; k + 2 <= full; k += 2 )
+    {
+        const __m128i w = _mm_loadu_si128( reinterpret_cast<__m128i const *>( bits + k ) );
+
+        if ( ! _mm_testc_si128( w, ones ) )
+            break;
+    }
+    return scalar::first_error( bits, n, k );
+}
+
+template< typename T >
+nsel_TARGET_SSE42
+std::size_t compact_values( word_type const * bits, T const * values, std::size_t n, T * out, std::true_type /*lanes*/ )
+{
+    using lane = lanes< sizeof(T) >;
+
+    const std::size_t total = n - count_errors( bits, n );
+    const std::size_t full  = n / word_bits;
+
+    std::size_t m = 0;
+    std::size_t k = 0;
+
+    // whole words, while full-width stores stay within the output:
+
+    for ( ; k != full && m + word_bits <= total; ++k )
+    {
+        T const * block = values + k * word_bits;
+
+        for ( std::size_t i = 0; i != word_bits; i += lane::count )
+        {
+            const unsigned mask = lane_bits( bits, k * word_bits + i, lane::count );
+            const __m128i  perm = _mm_loadu_si128( reinterpret_cast<__m128i const *>( lane::permutation( mask ) ) );
+            const __m128i  v    = _mm_loadu_si128( reinterpret_cast<__m128i const *>( block + i ) );
+
+            _mm_storeu_si128( reinterpret_cast<__m128i *>( out + m ), _mm_shuffle_epi8( v, perm ) );
+            m += static_cast<std::size_t>( _mm_popcnt_u32( mask ) );
+        }
+    }
+    return scalar::compact_values( bits, values, n, out + m, k, m );
+}
+
+template< typename T >
+std::size_t compact_values( word_type const * bits, T const * values, std::size_t n, T * out, std::false_type /*lanes*/ )
+{
+    return scalar::compact_values( bits, values, n, out );
+}
+
+template< typename T >
+std::size_t compact_values( word_type const * bits, T const * values, std::size_t n, T * out )
+{
+    return compact_values( bits, values, n, out, has_vector_lanes<T>() );
+}
+
+template< typename T >
+nsel_TARGET_SSE42
+void value_or_fill( word_type const * bits, T * values, std::size_t n, T const & v, std::true_type /*lanes*/ )
+{
+    using lane = lanes< sizeof(T) >;
+
+    const std::size_t blocks = n / lane::count;
+    const unsigned    all    = ( 1u << lane::count ) - 1;
+    const __m128i     fill   = lane::splat( &v );
+
+    for ( std::size_t b = 0; b != blocks; ++b )
+    {
+        const std::size_t pos  = b * lane::count;
+        const unsigned    mask = lane_bits( bits, pos, lane::count );
+
+        if ( mask == all )
+            continue;
+
+        __m128i * p = reinterpret_cast<__m128i *>( values + pos );
+
+        _mm_storeu_si128( p, _mm_blendv_epi8( fill, _mm_loadu_si128( p ), lane::select( mask ) ) );
+    }
+    value_or_fill_tail( bits, values, n, v, blocks * lane::count );
+}
+
+template< typename T >
+void value_or_fill( word_type const * bits, T * values, std::size_t n, T const & v, std::false_type /*lanes*/ )
+{
+    scalar::value_or_fill( bits, values, n, v );
+}
+
+template< typename T >
+void value_or_fill( word_type const * bits, T * values, std::size_t n, T const & v )
+{
+    value_or_fill( bits, values, n, v, has_vector_lanes<T>() );
+}
+
+} // namespace sse42
+
+// AVX2 kernels: nibble-table popcount, permute-based compaction, blend fill:
+
+namespace avx2 {
+
+/// permutations of 32-bit lanes that pack the selected elements to the front.
+
+struct compact_table
+{
+    std::uint32_t lanes4[256][8];   // 8 elements of 4 bytes, indexed by 8 presence bits
+    std::uint32_t lanes8[ 16][8];   // 4 elements of 8 bytes, indexed by 4 presence bits
+
+    compact_table()
+    {
+        for ( unsigned mask = 0; mask != 256; ++mask )
+        {
+            unsigned m = 0;
+            for ( unsigned i = 0; i != 8; ++i )
+                if ( mask & ( 1u << i ) ) { lanes4[mask][m++] = i; }
+            for ( ; m != 8; ++m )
+                lanes4[mask][m] = 0;
+        }
+        for ( unsigned mask = 0; mask != 16; ++mask )
+        {
+            unsigned m = 0;
+            for ( unsigned i = 0; i != 4; ++i )
+                if ( mask & ( 1u << i ) ) { lanes8[mask][m++] = 2 * i; lanes8[mask][m++] = 2 * i + 1; }
+            for ( ; m != 8; ++m )
+                lanes8[mask][m] = 0;
+        }
+    }
+
+    static compact_table const & instance()
+    {
+        static const compact_table table;
+        return table;
+    }
+};
+
+/// 256-bit operations on lanes of Size bytes.
+
+template< std::size_t Size >
+struct lanes;
+
+template<>
+struct lanes<4>
+{
+    enum { count = 8 };
+
+    nsel_TARGET_AVX2
+    static __m256i splat( void const * v ) noexcept
+    {
+        std::int32_t x; std::memcpy( &x, v, sizeof x ); return _mm256_set1_epi32( x );
+    }
+
+    nsel_TARGET_AVX2
+    static __m256i select( unsigned mask ) noexcept
+    {
+        const __m256i sel = _mm256_setr_epi32( 1, 2, 4, 8, 16, 32, 64, 128 );
+        return _mm256_cmpeq_epi32( _mm256_and_si256( _mm256_set1_epi32( static_cast<int>( mask ) ), sel ), sel );
+    }
+
+    static std::uint32_t const * permutation( unsigned mask ) noexcept
+    {
+        return compact_table::instance().lanes4[ mask ];
+    }
+};
+
+template<>
+struct lanes<8>
+{
+    enum { count = 4 };
+
+    nsel_TARGET_AVX2
+    static __m256i splat( void const * v ) noexcept
+    {
+        std::int64_t x; std::memcpy( &x, v, sizeof x ); return _mm256_set1_epi64x( x );
+    }
+
+    nsel_TARGET_AVX2
+    static __m256i select( unsigned mask ) noexcept
+    {
+        const __m256i sel = _mm256_setr_epi64x( 1, 2, 4, 8 );
+        return _mm256_cmpeq_epi64( _mm256_and_si256( _mm256_set1_epi64x( mask ), sel ), sel );
+    }
+
+    static std::uint32_t const * permutation( unsigned mask ) noexcept
+    {
+        return compact_table::instance().lanes8[ mask ];
+    }
+};
+
+nsel_TARGET_AVX2
+inline std::size_t count_errors( word_type const * bits, std::size_t n ) noexcept
+{
+    const std::size_t full = n / word_bits;
+
+    const __m256i nibbles = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 );
+    const __m256i low = _mm256_set1_epi8( 0x0f );
+
+    __m256i acc = _mm256_setzero_si256();
+    std::size_t k = 0;
+
+    for ( ; k + 4 <= full; k += 4 )
+    {
+        const __m256i w  = _mm256_loadu_si256( reinterpret_cast<__m256i const *>( bits + k ) );
+        const __m256i lo = _mm256_shuffle_epi8( nibbles, _mm256_and_si256( w, low ) );
+        const __m256i hi = _mm256_shuffle_epi8( nibbles, _mm256_and_si256( _mm256_srli_epi16( w, 4 ), low ) );
+
+        acc = _mm256_add_epi64( acc, _mm256_sad_epu8( _mm256_add_epi8( lo, hi ), _mm256_setzero_si256() ) );
+    }
+
+    std::size_t values = static_cast<std::size_t>(
+        _mm256_extract_epi64( acc, 0 ) + _mm256_extract_epi64( acc, 1 ) +
+        _mm256_extract_epi64( acc, 2 ) + _mm256_extract_epi64( acc, 3 ) );
+
+    for ( std::size_t nw = word_count( n ); k != nw; ++k )
+    {
+        values += static_cast<std::size_t>( _mm_popcnt_u64( bits[k] & word_mask( k, n ) ) );
+    }
+    return n - values;
+}
+
+nsel_TARGET_AVX2
+inline std::size_t first_error( word_type const * bits, std::size_t n ) noexcept
+{
+    const std::size_t full = n / word_bits;
+    const __m256i ones = _mm256_set1_epi64x( -1 );
+
+    std::size_t k = 0;
+    for ( ; k + 4 <= full; k += 4 )
+    {
+        const __m256i w = _mm256_loadu_si256( reinterpret_cast<__m256i const *>( bits + k ) );
+
+        if ( ! _mm256_testc_si256( w, ones ) )
+            break;
+    }
+    return scalar::first_error( bits, n, k );
+}
+
+template< typename T >
+nsel_TARGET_AVX2
+std::size_t compact_values( word_type const * bits, T const * values, std::size_t n, T * out, std::true_type /*lanes*/ )
+{
+    using lane = lanes< sizeof(T) >;
+
+    const std::size_t total = n - count_errors( bits, n );
+    const std::size_t full  = n / word_bits;
+
+    std::size_t m = 0;
+    std::size_t k = 0;
+
+    // whole words, while full-width stores stay within the output:
+
+    for ( ; k != full && m + word_bits <= total; ++k )
+    {
+        T const * block = values + k * word_bits;
+
+        for ( std::size_t i = 0; i != word_bits; i += lane::count )
+        {
+            const unsigned mask = sse42::lane_bits( bits, k * word_bits + i, lane::count );
+            const __m256i  perm = _mm256_loadu_si256( reinterpret_cast<__m256i const *>( lane::permutation( mask ) ) );
+            const __m256i  v    = _mm256_loadu_si256( reinterpret_cast<__m256i const *>( block + i ) );
+
+            _mm256_storeu_si256( reinterpret_cast<__m256i *>( out + m ), _mm256_permutevar8x32_epi32( v, perm ) );
+            m += static_cast<std::size_t>( _mm_popcnt_u32( mask ) );
+        }
+    }
+    return scalar::compact_values( bits, values, n, out + m, k, m );
+}
+
+template< typename T >
+std::size_t compact_values( word_type const * bits, T const * values, std::size_t n, T * out, std::false_type /*lanes*/ )
+{
+    return scalar::compact_values( bits, values, n, out );
+}
+
+template< typename T >
+std::size_t compact_values( word_type const * bits, T const * values, std::size_t n, T * out )
+{
+    return compact_values( bits, values, n, out, has_vector_lanes<T>() );
+}
+
+template< typename T >
+nsel_TARGET_AVX2
+void value_or_fill( word_type const * bits, T * values, std::size_t n, T const & v, std::true_type /*lanes*/ )
+{
+    using lane = lanes< sizeof(T) >;
+
+    const std::size_t blocks = n / lane::count;
+    const unsigned    all    = ( 1u << lane::count ) - 1;
+    const __m256i     fill   = lane::splat( &v );
+
+    for ( std::size_t b = 0; b != blocks; ++b )
+    {
+        const std::size_t pos  = b * lane::count;
+        const unsigned    mask = sse42::lane_bits( bits, pos, lane::count );
+
+        if ( mask == all )
+            continue;
+
+        __m256i * p = reinterpret_cast<__m256i *>( values + pos );
+
+        _mm256_storeu_si256( p, _mm256_blendv_epi8( fill, _mm256_loadu_si256( p ), lane::select( mask ) ) );
+    }
+    sse42::value_or_fill_tail( bits, values, n, v, blocks * lane::count );
+}
+
+template< typename T >
+void value_or_fill( word_type const * bits, T * values, std::size_t n, T const & v, std::false_type /*lanes*/ )
+{
+    scalar::value_or_fill( bits, values, n, v );
+}
+
+template< typename T >
+void value_or_fill( word_type const * bits, T * values, std::size_t n, T const & v )
+{
+    value_or_fill( bits, values, n, v, has_vector_lanes<T>() );
+}
+
+} // namespace avx2
+
+#endif // nsel_HAVE_X86_SIMD
+
+inline simd_level detect_simd_level() noexcept
+{
+#if !nsel_HAVE_X86_SIMD
+    return simd_level::scalar;
+#elif defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid( info, 1 );
+    const bool sse42 = ( info[2] & ( 1 << 20 ) ) && ( info[2] & ( 1 << 23 ) );
+    const bool osavx = ( info[2] & ( 1 << 27 ) ) && ( info[2] & ( 1 << 28 ) ) && ( _xgetbv( 0 ) & 6 ) == 6;
+    __cpuidex( info, 7, 0 );
+    const bool avx2  = osavx && ( info[1] & ( 1 << 5 ) );
+    return avx2 ? simd_level::avx2 : sse42 ? simd_level::sse42 : simd_level::scalar;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports( "avx2"   ) && __builtin_cpu_supports( "popcnt" ) ? simd_level::avx2
+         : __builtin_cpu_supports( "sse4.2" ) && __builtin_cpu_supports( "popcnt" ) ? simd_level::sse42
+         : simd_level::scalar;
+#endif
+}
+
+} // namespace simd
+
+/// instruction set selected for this CPU, detected once.
+
+inline simd_level current_simd_level() noexcept
+{
+    static const simd_level level = simd::detect_simd_level();
+    return level;
+}
+
+// batch kernels over a validity bitmap of n bits and a value array of n elements:
+
+inline std::size_t count_errors( simd::word_type const * bits, std::size_t n ) noexcept
+{
+#if nsel_HAVE_X86_SIMD
+    switch ( current_simd_level() )
+    {
+        case simd_level::avx2:  return simd::avx2 ::count_errors( bits, n );
+        case simd_level::sse42: return simd::sse42::count_errors( bits, n );
+        default: break;
+    }
+#endif
+    return simd::scalar::count_errors( bits, n );
+}
+
+/// index of the first error, or n if there is none.
+
+inline std::size_t first_error( simd::word_type const * bits, std::size_t n ) noexcept
+{
+#if nsel_HAVE_X86_SIMD
+    switch ( current_simd_level() )
+    {
+        case simd_level::avx2:  return simd::avx2 ::first_error( bits, n );
+        case simd_level::sse42: return simd::sse42::first_error( bits, n );
+        default: break;
+    }
+#endif
+    return simd::scalar::first_error( bits, n );
+}
+
+/// copy the values in order to out, which must have room for all of them; return their number.
+
+template< typename T >
+std::size_t compact_values( simd::word_type const * bits, T const * values, std::size_t n, T * out )
+{
+#if nsel_HAVE_X86_SIMD
+    switch ( current_simd_level() )
+    {
+        case simd_level::avx2:  return simd::avx2 ::compact_values( bits, values, n, out );
+        case simd_level::sse42: return simd::sse42::compact_values( bits, values, n, out );
+        default: break;
+    }
+#endif
+    return simd::scalar::compact_values( bits, values, n, out );
+}
+
+/// replace the value slot of every error with v.
+
+template< typename T >
+void value_or_fill( simd::word_type const * bits, T * values, std::size_t n, T const & v )
+{
+#if nsel_HAVE_X86_SIMD
+    switch ( current_simd_level() )
+    {
+        case simd_level::avx2:  return simd::avx2 ::value_or_fill( bits, values, n, v );
+        case simd_level::sse42: return simd::sse42::value_or_fill( bits, values, n, v );
+        default: break;
+    }
+#endif
+    simd::scalar::value_or_fill( bits, values, n, v );
+}
+
+// batch kernels over an expected_vector:
+
+template< typename T, typename E >
+std::size_t count_errors( expected_vector<T,E> const & v ) noexcept
+{
+    return count_errors( v.validity_data(), v.size() );
+}
+
+template< typename T, typename E >
+std::size_t first_error( expected_vector<T,E> const & v ) noexcept
+{
+    return first_error( v.validity_data(), v.size() );
+}
+
+template< typename T, typename E >
+std::size_t compact_values( expected_vector<T,E> const & v, T * out )
+{
+    return compact_values( v.validity_data(), v.value_data(), v.size(), out );
+}
+
+/// make every value slot hold value_or( x ); errors remain in place.
+
+template< typename T, typename E >
+void value_or_fill( expected_vector<T,E> & v, T const & x )
+{
+    value_or_fill( v.validity_data(), v.value_data(), v.size(), x );
+}
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_SIMD_LITE_HPP
@@ -0,0 +1,438 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_slot: single-shot, single-producer single-consumer handoff of an
+// expected<T,E> between threads, without allocation or locks.
+
+#ifndef NONSTD_EXPECTED_SLOT_LITE_HPP
+#define NONSTD_EXPECTED_SLOT_LITE_HPP
+
+#include "expected.hpp"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+// Use std::atomic<>::wait() and notify_all() if available:
+
+#if defined(__cpp_lib_atomic_wait) && __cpp_lib_atomic_wait >= 201907L
+# define nsel_HAVE_ATOMIC_WAIT  1
+#else
+# define nsel_HAVE_ATOMIC_WAIT  0
+#endif
+
+// Number of polls of the state before a waiting thread yields:
+
+#ifndef  nsel_CONFIG_SLOT_SPIN_COUNT
+# define nsel_CONFIG_SLOT_SPIN_COUNT  64
+#endif
+
+namespace nonstd { namespace expected_lite {
+
+template< typename T, typename E >
+class expected_promise;
+
+template< typename T, typename E >
+class expected_future;
+
+class work_stealing_pool;
+
+namespace detail {
+
+/// decayed result of calling an F lvalue with Args.
+
+template< typename F, typename... Args >
+using call_result = typename std::decay< decltype( std::declval<F &>()( std::declval<Args>()... ) ) >::type;
+
+/// future for the result R of a function: expected_future<T,E> for an R of
+/// expected<T,E>, otherwise expected_future<R, std::exception_ptr>.
+
+template< typename R >
+struct future_of
+{
+    using value_type = R;
+    using error_type = std::exception_ptr;
+    using type       = expected_future<R, std::exception_ptr>;
+};
+
+template< typename T, typename E >
+struct future_of< expected<T, E> >
+{
+    using value_type = T;
+    using error_type = E;
+    using type       = expected_future<T, E>;
+};
+
+} // namespace detail
+
+/// holds the expected<T,E> that one producer thread hands to one consumer
+/// thread. The result is constructed in place in the slot, which consists
+/// of the storage of an expected<T,E> and an atomic state word.
+///
+/// The consumer either waits for the result, or registers a continuation
+/// that runs inline on the thread that completes the handoff: the producer
+/// if it comes first, otherwise the consumer itself.
+
+template< typename T, typename E >
+class expected_slot
+{
+public:
+    using value_type    = T;
+    using error_type    = E;
+    using result_type   = expected<T, E>;
+    using continuation  = void (*)( expected_slot & slot, void * context );
+
+    expected_slot() noexcept
+        : m_state( empty )
+    {}
+
+    expected_slot( expected_slot const & ) = delete;
+    expected_slot & operator=( expected_slot const & ) = delete;
+
+    ~expected_slot()
+    {
+        destroy();
+    }
+
+    // producer:
+
+    template< typename... Args >
+    void set_value( Args&&... args )
+    {
+        assert( m_state.load( std::memory_order_relaxed ) != ready );
+
+        emplace_value( std::is_void<T>(), std::forward<Args>( args )... );
+        m_contained.set_has_value( true );
+        publish();
+    }
+
+    template< typename... Args >
+    void set_error( Args&&... args )
+    {
+        assert( m_state.load( std::memory_order_relaxed ) != ready );
+
+        m_contained.emplace_error( std::forward<Args>( args )... );
+        m_contained.set_has_value( false );
+        publish();
+    }
+
+    void set_result( result_type const & r )
+    {
+        if ( r.has_value() ) set_result_value( std::is_void<T>(), r );
+        else                 set_error( r.error() );
+    }
+
+    void set_result( result_type && r )
+    {
+        if ( r.has_value() ) set_result_value( std::is_void<T>(), std::move( r ) );
+        else                 set_error( std::move( r ).error() );
+    }
+
+    // consumer:
+
+    bool is_ready() const noexcept
+    {
+        return m_state.load( std::memory_order_acquire ) == ready;
+    }
+
+    /// block until the result is present; spins briefly, then sleeps on the
+    /// state word via std::atomic<>::wait(), or yields if that is unavailable.
+
+    void wait() const noexcept
+    {
+        for ( int spin = 0; spin != nsel_CONFIG_SLOT_SPIN_COUNT; ++spin )
+        {
+            if ( is_ready() )
+                return;
+        }
+
+        for ( unsigned state = m_state.load( std::memory_order_acquire ); state != ready; state = m_state.load( std::memory_order_acquire ) )
+        {
+#if nsel_HAVE_ATOMIC_WAIT
+            if ( state == notifying ) std::this_thread::yield();
+            else                      m_state.wait( state, std::memory_order_acquire );
+#else
+            std::this_thread::yield();
+#endif
+        }
+    }
+
+    /// block until the result is present or rel_time has passed; true if present.
+
+    template< typename Rep, typename Period >
+    bool wait_for( std::chrono::duration<Rep, Period> const & rel_time ) const
+    {
+        return wait_until( std::chrono::steady_clock::now() + rel_time );
+    }
+
+    template< typename Clock, typename Duration >
+    bool wait_until( std::chrono::time_point<Clock, Duration> const & abs_time ) const
+    {
+        while ( ! is_ready() )
+        {
+            if ( Clock::now() >= abs_time )
+                return false;
+
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    /// wait for the result and move it out; call at most once per handoff.
+
+    result_type get()
+    {
+        wait();
+        return take( std::is_void<T>() );
+    }
+
+    /// run f( *this, context ) once the result is present. Runs f inline on
+    /// the calling thread if the result is already present; otherwise on the
+    /// producer thread, from within set_value(), set_error() or set_result().
+    /// Register at most one continuation per handoff.
+
+    void on_ready( continuation f, void * context )
+    {
+        m_continuation = f;
+        m_context      = context;
+
+        unsigned state = empty;
+
+        if ( ! m_state.compare_exchange_strong( state, waiting, std::memory_order_acq_rel, std::memory_order_acquire ) )
+        {
+            assert( state == notifying || state == ready );
+            wait();
+            f( *this, context );
+        }
+    }
+
+    /// same, with a callable that is invoked as f( slot ) and must outlive the handoff.
+
+    template< typename F >
+    void on_ready( F & f )
+    {
+        on_ready( &invoke<F>, std::addressof( f ) );
+    }
+
+    /// make the slot available for another handoff; neither side may be active.
+
+    void reset() noexcept
+    {
+        destroy();
+        m_state.store( empty, std::memory_order_relaxed );
+    }
+
+    expected_promise<T, E> get_promise() noexcept
+    {
+        return expected_promise<T, E>( *this );
+    }
+
+    expected_future<T, E> get_future() noexcept
+    {
+        return expected_future<T, E>( *this );
+    }
+
+private:
+    // notifying: the result is present, but the producer still wakes waiters
+    // on the state word or reads the continuation; the slot may go away only
+    // once the state is ready.
+
+    enum : unsigned { empty, waiting, notifying, ready };
+
+    template< typename F >
+    static void invoke( expected_slot & slot, void * f )
+    {
+        ( *static_cast<F *>( f ) )( slot );
+    }
+
+    /// make the result visible; the final store of ready is the producer's
+    /// last access of the slot, as a consumer may destroy it as soon as it
+    /// observes that state. A registered continuation and its context are
+    /// therefore read before that store, while the state is notifying.
+
+    void publish()
+    {
+        if ( m_state.exchange( notifying, std::memory_order_acq_rel ) != waiting )
+        {
+#if nsel_HAVE_ATOMIC_WAIT
+            m_state.notify_all();
+#endif
+            m_state.store( ready, std::memory_order_release );
+            return;
+        }
+
+        continuation const f       = m_continuation;
+        void *       const context = m_context;
+
+        m_state.store( ready, std::memory_order_release );
+        f( *this, context );
+    }
+
+    void destroy() noexcept
+    {
+        if ( m_state.load( std::memory_order_acquire ) == ready )
+            destroy( std::is_void<T>() );
+    }
+
+    void destroy( std::false_type /*void*/ ) noexcept
+    {
+        if ( m_contained.has_value() ) m_contained.destruct_value();
+        else                           m_contained.destruct_error();
+    }
+
+    void destroy( std::true_type /*void*/ ) noexcept
+    {
+        if ( ! m_contained.has_value() )
+            m_contained.destruct_error();
+    }
+
+    template< typename... Args >
+    void emplace_value( std::false_type /*void*/, Args&&... args )
+    {
+        m_contained.emplace_value( std::forward<Args>( args )... );
+    }
+
+    void emplace_value( std::true_type /*void*/ ) noexcept {}
+
+    template< typename R >
+    void set_result_value( std::false_type /*void*/, R && r )
+    {
+        set_value( *std::forward<R>( r ) );
+    }
+
+    template< typename R >
+    void set_result_value( std::true_type /*void*/, R && )
+    {
+        set_value();
+    }
+
+    result_type take( std::false_type /*void*/ )
+    {
+        if ( m_contained.has_value() )
+            return result_type( std::move( m_contained.value() ) );
+
+        return result_type( unexpect, std::move( m_contained.error() ) );
+    }
+
+    result_type take( std::true_type /*void*/ )
+    {
+        if ( m_contained.has_value() )
+            return result_type();
+
+        return result_type( unexpect, std::move( m_contained.error() ) );
+    }
+
+private:
+    detail::storage_t_impl<T, E> m_contained;
+    std::atomic<unsigned>        m_state;
+    continuation                 m_continuation = nullptr;
+    void *                       m_context      = nullptr;
+};
+
+/// producer side of an expected_slot.
+
+template< typename T, typename E >
+class expected_promise
+{
+public:
+    explicit expected_promise( expected_slot<T, E> & slot ) noexcept
+        : m_slot( &slot )
+    {}
+
+    template< typename... Args >
+    void set_value( Args&&... args )
+    {
+        m_slot->set_value( std::forward<Args>( args )... );
+    }
+
+    template< typename... Args >
+    void set_error( Args&&... args )
+    {
+        m_slot->set_error( std::forward<Args>( args )... );
+    }
+
+    template< typename R >
+    void set_result( R && r )
+    {
+        m_slot->set_result( std::forward<R>( r ) );
+    }
+
+private:
+    expected_slot<T, E> * m_slot;
+};
+
+/// consumer side of an expected_slot. A future from async_expected() shares
+/// ownership of its slot and allows a continuation via then().
+
+template< typename T, typename E >
+class expected_future
+{
+public:
+    explicit expected_future( expected_slot<T, E> & slot ) noexcept
+        : m_slot( &slot )
+    {}
+
+    expected_future( expected_slot<T, E> & slot, std::shared_ptr<void> owner, work_stealing_pool * pool ) noexcept
+        : m_slot( &slot )
+        , m_owner( std::move( owner ) )
+        , m_pool( pool )
+    {}
+
+    bool is_ready() const noexcept
+    {
+        return m_slot->is_ready();
+    }
+
+    void wait() const noexcept
+    {
+        m_slot->wait();
+    }
+
+    template< typename Rep, typename Period >
+    bool wait_for( std::chrono::duration<Rep, Period> const & rel_time ) const
+    {
+        return m_slot->wait_for( rel_time );
+    }
+
+    expected<T, E> get()
+    {
+        return m_slot->get();
+    }
+
+    template< typename F >
+    void on_ready( F & f )
+    {
+        m_slot->on_ready( f );
+    }
+
+    void on_ready( typename expected_slot<T, E>::continuation f, void * context )
+    {
+        m_slot->on_ready( f, context );
+    }
+
+    /// run f( result ) on the pool once the result is present, preferably on
+    /// the worker that produced it; consumes the result. Requires a future
+    /// from async_expected(), see expected_pool.hpp.
+
+    template< typename F >
+    auto then( F f ) -> typename detail::future_of< detail::call_result< F, expected<T, E> > >::type;
+
+private:
+    expected_slot<T, E> * m_slot;
+    std::shared_ptr<void> m_owner;
+    work_stealing_pool *  m_pool = nullptr;
+};
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_SLOT_LITE_HPP
@@ -0,0 +1,616 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_validated: validated<T,E,N>, a value or all errors that prevented it.
+
+#ifndef NONSTD_EXPECTED_VALIDATED_LITE_HPP
+#define NONSTD_EXPECTED_VALIDATED_LITE_HPP
+
+#include "expected.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace nonstd { namespace expected_lite {
+
+/// class error_list: a sequence of errors that keeps up to N of them inline
+/// and moves them to the heap when more arrive.
+
+template< typename E, std::size_t N >
+class error_list
+{
+    static_assert( N > 0, "error_list: inline capacity N must be at least 1" );
+
+public:
+    using value_type      = E;
+    using size_type       = std::size_t;
+    using reference       = E &;
+    using const_reference = E const &;
+    using iterator        = E *;
+    using const_iterator  = E const *;
+
+    enum { inline_capacity = N };
+
+    error_list() noexcept
+        : m_data( inline_data() )
+        , m_size( 0 )
+        , m_capacity( N )
+    {}
+
+    error_list( std::initializer_list<E> il )
+        : error_list()
+    {
+        reserve( il.size() );
+        for ( auto const & e : il )
+            push_back( e );
+    }
+
+    error_list( error_list const & other )
+        : error_list()
+    {
+        append( other );
+    }
+
+    error_list( error_list && other ) noexcept( std::is_nothrow_move_constructible<E>::value )
+        : error_list()
+    {
+        take( other );
+    }
+
+    ~error_list()
+    {
+        clear();
+        release();
+    }
+
+    error_list & operator=( error_list const & other )
+    {
+        if ( this != &other )
+        {
+            clear();
+            append( other );
+        }
+        return *this;
+    }
+
+    error_list & operator=( error_list && other ) noexcept( std::is_nothrow_move_constructible<E>::value )
+    {
+        if ( this != &other )
+        {
+            clear();
+            release();
+            take( other );
+        }
+        return *this;
+    }
+
+    // capacity:
+
+    size_type size() const noexcept
+    {
+        return m_size;
+    }
+
+    size_type capacity() const noexcept
+    {
+        return m_capacity;
+    }
+
+    bool empty() const noexcept
+    {
+        return m_size == 0;
+    }
+
+    /// true if the errors are held in the inline buffer.
+
+    bool is_inline() const noexcept
+    {
+        return m_data == inline_data();
+    }
+
+    void reserve( size_type n )
+    {
+        if ( n > m_capacity )
+            reallocate( n );
+    }
+
+    // access:
+
+    E * data() noexcept { return m_data; }
+    E const * data() const noexcept { return m_data; }
+
+    iterator begin() noexcept { return m_data; }
+    iterator end()   noexcept { return m_data + m_size; }
+
+    const_iterator begin() const noexcept { return m_data; }
+    const_iterator end()   const noexcept { return m_data + m_size; }
+
+    E & operator[]( size_type pos ) noexcept { return assert( pos < m_size ), m_data[ pos ]; }
+    E const & operator[]( size_type pos ) const noexcept { return assert( pos < m_size ), m_data[ pos ]; }
+
+    E & front() noexcept { return (*this)[ 0 ]; }
+    E const & front() const noexcept { return (*this)[ 0 ]; }
+
+    E & back() noexcept { return (*this)[ m_size - 1 ]; }
+    E const & back() const noexcept { return (*this)[ m_size - 1 ]; }
+
+    // modifiers:
+
+    template< typename... Args >
+    E & emplace_back( Args&&... args )
+    {
+        if ( m_size == m_capacity )
+        {
+            // args may refer to an error of this list, which growing moves:
+
+            E e( std::forward<Args>( args )... );
+            reallocate( 2 * m_capacity );
+            return emplace_back( std::move( e ) );
+        }
+
+        E * where = m_data + m_size;
+        new( where ) E( std::forward<Args>( args )... );
+        ++m_size;
+        return *where;
+    }
+
+    void push_back( E const & e )
+    {
+        emplace_back( e );
+    }
+
+    void push_back( E && e )
+    {
+        emplace_back( std::move( e ) );
+    }
+
+    void append( error_list const & other )
+    {
+        reserve( m_size + other.size() );
+        for ( auto const & e : other )
+            emplace_back( e );
+    }
+
+    void append( error_list && other )
+    {
+        reserve( m_size + other.size() );
+        for ( auto & e : other )
+            emplace_back( std::move( e ) );
+        other.clear();
+    }
+
+    void clear() noexcept
+    {
+        for ( size_type i = 0; i != m_size; ++i )
+            m_data[ i ].~E();
+        m_size = 0;
+    }
+
+private:
+    E * inline_data() noexcept
+    {
+        return reinterpret_cast<E *>( m_inline );
+    }
+
+    E const * inline_data() const noexcept
+    {
+        return reinterpret_cast<E const *>( m_inline );
+    }
+
+    // move the errors to heap storage with room for n of them.
+
+    void reallocate( size_type n )
+    {
+        E * data = static_cast<E *>( ::operator new( n * sizeof(E) ) );
+        size_type i = 0;
+
+#if !nsel_CONFIG_NO_EXCEPTIONS
+        try
+#endif
+        {
+            for ( ; i != m_size; ++i )
+                new( data + i ) E( std::move_if_noexcept( m_data[ i ] ) );
+        }
+#if !nsel_CONFIG_NO_EXCEPTIONS
+        catch (...)
+        {
+            while ( i != 0 )
+                data[ --i ].~E();
+            ::operator delete( data );
+            throw;
+        }
+#endif
+        const size_type size = m_size;
+
+        clear();
+        release();
+
+        m_data     = data;
+        m_size     = size;
+        m_capacity = n;
+    }
+
+    void release() noexcept
+    {
+        if ( ! is_inline() )
+            ::operator delete( m_data );
+
+        m_data     = inline_data();
+        m_capacity = N;
+    }
+
+    // take the errors of other, which must be empty and inline itself.
+
+    void take( error_list & other )
+    {
+        if ( other.is_inline() )
+        {
+            for ( auto & e : other )
+                emplace_back( std::move( e ) );
+            other.clear();
+        }
+        else
+        {
+            m_data     = other.m_data;
+            m_size     = other.m_size;
+            m_capacity = other.m_capacity;
+
+            other.m_data     = other.inline_data();
+            other.m_size     = 0;
+            other.m_capacity = N;
+        }
+    }
+
+private:
+    alignas(E) unsigned char m_inline[ N * sizeof(E) ];
+
+    E *       m_data;
+    size_type m_size;
+    size_type m_capacity;
+};
+
+template< typename E, std::size_t N >
+bool operator==( error_list<E,N> const & x, error_list<E,N> const & y )
+{
+    return x.size() == y.size() && std::equal( x.begin(), x.end(), y.begin() );
+}
+
+template< typename E, std::size_t N >
+bool operator!=( error_list<E,N> const & x, error_list<E,N> const & y )
+{
+    return !( x == y );
+}
+
+/// class validated: a value, or the list of all errors that prevented it.
+///
+/// Holds value or error_list<E,N> in the discriminated union that also
+/// underlies expected<T,E>. Unlike expected, combine() collects the errors
+/// of all its arguments instead of stopping at the first one.
+
+template< typename T, typename E, std::size_t N = 4 >
+class validated
+{
+public:
+    using value_type      = T;
+    using error_type      = E;
+    using error_list_type = error_list<E, N>;
+
+    // constructors:
+
+    template< typename U = T
+        , typename = typename std::enable_if< std::is_default_constructible<U>::value >::type
+    >
+    validated()
+        : contained( true )
+    {
+        contained.construct_value( value_type() );
+    }
+
+    validated( value_type const & v )
+        : contained( true )
+    {
+        contained.construct_value( v );
+    }
+
+    validated( value_type && v )
+        : contained( true )
+    {
+        contained.construct_value( std::move( v ) );
+    }
+
+    template< typename... Args >
+    explicit validated( nonstd_lite_in_place_t(T), Args&&... args )
+        : contained( true )
+    {
+        contained.emplace_value( std::forward<Args>( args )... );
+    }
+
+    validated( unexpected_type<E> const & error )
+        : contained( false )
+    {
+        contained.emplace_error();
+        contained.error().push_back( error.value() );
+    }
+
+    validated( unexpected_type<E> && error )
+        : contained( false )
+    {
+        contained.emplace_error();
+        contained.error().push_back( std::move( error.value() ) );
+    }
+
+    validated( unexpect_t, error_list_type errors )
+        : contained( false )
+    {
+        assert( ! errors.empty() );
+        contained.construct_error( std::move( errors ) );
+    }
+
+    validated( expected<T, E> const & other )
+        : contained( other.has_value() )
+    {
+        if ( has_value() ) contained.construct_value( *other );
+        else             { contained.emplace_error(); contained.error().push_back( other.error() ); }
+    }
+
+    validated( expected<T, E> && other )
+        : contained( other.has_value() )
+    {
+        if ( has_value() ) contained.construct_value( std::move( *other ) );
+        else             { contained.emplace_error(); contained.error().push_back( std::move( other.error() ) ); }
+    }
+
+    validated( validated const & ) = default;
+    validated( validated && ) = default;
+
+    ~validated()
+    {
+        if ( has_value() ) contained.destruct_value();
+        else               contained.destruct_error();
+    }
+
+    // assignment:
+
+    validated & operator=( validated const & other )
+    {
+        validated( other ).swap( *this );
+        return *this;
+    }
+
+    validated & operator=( validated && other ) noexcept
+    (
+        std::is_nothrow_move_constructible<T>::value
+        && std::is_nothrow_move_constructible<E>::value )
+    {
+        validated( std::move( other ) ).swap( *this );
+        return *this;
+    }
+
+    void swap( validated & other ) noexcept
+    (
+        std::is_nothrow_move_constructible<T>::value && std17::is_nothrow_swappable<T&>::value &&
+        std::is_nothrow_move_constructible<E>::value )
+    {
+        using std::swap;
+
+        if      (   has_value() &&   other.has_value() ) { swap( contained.value(), other.contained.value() ); }
+        else if ( ! has_value() && ! other.has_value() ) { swap( contained.error(), other.contained.error() ); }
+        else if (   has_value() && ! other.has_value() ) { error_list_type t( std::move( other.contained.error() ) );
+                                                           other.contained.destruct_error();
+                                                           other.contained.construct_value( std::move( contained.value() ) );
+                                                           contained.destruct_value();
+                                                           contained.construct_error( std::move( t ) );
+                                                           contained.set_has_value( false );
+                                                           other.contained.set_has_value( true );
+                                                         }
+        else                                             { other.swap( *this ); }
+    }
+
+    // observers:
+
+    bool has_value() const noexcept
+    {
+        return contained.has_value();
+    }
+
+    constexpr explicit operator bool() const noexcept
+    {
+        return contained.has_value();
+    }
+
+    value_type const * operator->() const
+    {
+        return assert( has_value() ), contained.value_ptr();
+    }
+
+    value_type * operator->()
+    {
+        return assert( has_value() ), contained.value_ptr();
+    }
+
+    value_type const & operator*() const &
+    {
+        return assert( has_value() ), contained.value();
+    }
+
+    value_type & operator*() &
+    {
+        return assert( has_value() ), contained.value();
+    }
+
+    value_type && operator*() &&
+    {
+        return assert( has_value() ), std::move( contained.value() );
+    }
+
+    value_type const & value() const &
+    {
+        return has_value()
+            ? ( contained.value() )
+            : ( error_traits<error_list_type>::rethrow( contained.error() ), contained.value() );
+    }
+
+    value_type & value() &
+    {
+        return has_value()
+            ? ( contained.value() )
+            : ( error_traits<error_list_type>::rethrow( contained.error() ), contained.value() );
+    }
+
+    value_type && value() &&
+    {
+        return std::move( has_value()
+            ? ( contained.value() )
+            : ( error_traits<error_list_type>::rethrow( contained.error() ), contained.value() ) );
+    }
+
+    error_list_type const & errors() const &
+    {
+        return assert( ! has_value() ), contained.error();
+    }
+
+    error_list_type & errors() &
+    {
+        return assert( ! has_value() ), contained.error();
+    }
+
+    error_list_type && errors() &&
+    {
+        return assert( ! has_value() ), std::move( contained.error() );
+    }
+
+    template< typename U >
+    value_type value_or( U && v ) const &
+    {
+        return has_value() ? contained.value() : static_cast<T>( std::forward<U>( v ) );
+    }
+
+    // conversion:
+
+    /// the value, or the first error.
+
+    expected<T, E> to_expected() const &
+    {
+        return has_value() ? expected<T, E>( contained.value() ) : expected<T, E>( unexpect, contained.error().front() );
+    }
+
+    expected<T, E> to_expected() &&
+    {
+        return has_value() ? expected<T, E>( std::move( contained.value() ) ) : expected<T, E>( unexpect, std::move( contained.error().front() ) );
+    }
+
+    /// the value, or all errors.
+
+    expected<T, error_list_type> to_expected_all() const &
+    {
+        return has_value() ? expected<T, error_list_type>( contained.value() ) : expected<T, error_list_type>( unexpect, contained.error() );
+    }
+
+    expected<T, error_list_type> to_expected_all() &&
+    {
+        return has_value() ? expected<T, error_list_type>( std::move( contained.value() ) ) : expected<T, error_list_type>( unexpect, std::move( contained.error() ) );
+    }
+
+private:
+    detail::storage_t
+    <
+        T
+        , error_list_type
+        , std::is_copy_constructible<T>::value && std::is_copy_constructible<E>::value
+        , std::is_move_constructible<T>::value && std::is_move_constructible<E>::value
+    >
+    contained;
+};
+
+template< typename T, typename E, std::size_t N >
+void swap( validated<T,E,N> & x, validated<T,E,N> & y ) noexcept( noexcept( x.swap( y ) ) )
+{
+    x.swap( y );
+}
+
+namespace detail {
+
+template< typename V >
+using validated_value_t = typename std::decay<V>::type::value_type;
+
+template< typename V >
+using validated_errors_t = typename std::decay<V>::type::error_list_type;
+
+template< typename L, typename... Vs >
+struct same_error_lists : std::true_type {};
+
+template< typename L, typename V, typename... Vs >
+struct same_error_lists< L, V, Vs... > : std::integral_constant< bool,
+    std::is_same< L, validated_errors_t<V> >::value && same_error_lists< L, Vs... >::value > {};
+
+/// append the errors of v, moving them from an rvalue.
+
+template< typename L, typename V >
+int append_errors( L & list, V && v )
+{
+    if ( ! v.has_value() )
+        list.append( std::forward<V>( v ).errors() );
+    return 0;
+}
+
+} // namespace detail
+
+/// the values of all arguments in a tuple, or the errors of all arguments
+/// that have none, in argument order. Makes a single pass over the arguments.
+
+template< typename V, typename... Vs
+    , typename L = detail::validated_errors_t<V>
+>
+auto combine( V && v, Vs &&... vs )
+    -> validated< std::tuple< detail::validated_value_t<V>, detail::validated_value_t<Vs>... >, typename L::value_type, L::inline_capacity >
+{
+    static_assert( detail::same_error_lists< L, Vs... >::value, "combine(): all error lists must be of the same type" );
+
+    using result = validated< std::tuple< detail::validated_value_t<V>, detail::validated_value_t<Vs>... >, typename L::value_type, L::inline_capacity >;
+
+    L errors;
+    const int expand[] = { detail::append_errors( errors, std::forward<V>( v ) ), detail::append_errors( errors, std::forward<Vs>( vs ) )... };
+    (void) expand;
+
+    if ( ! errors.empty() )
+        return result( unexpect, std::move( errors ) );
+
+    return result( nonstd_lite_in_place( typename result::value_type ), *std::forward<V>( v ), *std::forward<Vs>( vs )... );
+}
+
+/// f applied to the values of all arguments, or the errors of all arguments
+/// that have none, in argument order.
+
+template< typename F, typename V, typename... Vs
+    , typename L = detail::validated_errors_t<V>
+    , typename R = typename std::decay< decltype( std::declval<F>()( *std::declval<V>(), *std::declval<Vs>()... ) ) >::type
+>
+auto combine_with( F && f, V && v, Vs &&... vs )
+    -> validated< R, typename L::value_type, L::inline_capacity >
+{
+    static_assert( detail::same_error_lists< L, Vs... >::value, "combine_with(): all error lists must be of the same type" );
+
+    using result = validated< R, typename L::value_type, L::inline_capacity >;
+
+    L errors;
+    const int expand[] = { detail::append_errors( errors, std::forward<V>( v ) ), detail::append_errors( errors, std::forward<Vs>( vs ) )... };
+    (void) expand;
+
+    if ( ! errors.empty() )
+        return result( unexpect, std::move( errors ) );
+
+    return result( nonstd_lite_in_place( R ), std::forward<F>( f )( *std::forward<V>( v ), *std::forward<Vs>( vs )... ) );
+}
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_VALIDATED_LITE_HPP
@@ -0,0 +1,583 @@
+// This version targets C++11 and later.
+//
+// Copyright (C) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected_vector: a sequence of expected<T,E> in structure-of-arrays layout.
+
+#ifndef NONSTD_EXPECTED_VECTOR_LITE_HPP
+#define NONSTD_EXPECTED_VECTOR_LITE_HPP
+
+#include "expected.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace nonstd { namespace expected_lite {
+
+/// class expected_vector: values in a dense array, their presence in a bitmap
+/// and the errors in a sparse table ordered by index.
+///
+/// Element i holds a value if bit i of the bitmap is set; value slot i then
+/// contains it. Otherwise value slot i holds a value-initialized T and the
+/// error table contains an entry for i. Requires a default-constructible T.
+
+template< typename T, typename E >
+class expected_vector
+{
+    template< bool IsConst > class basic_reference;
+    template< bool IsConst > class basic_iterator;
+
+public:
+    using value_type      = expected<T, E>;
+    using size_type       = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using word_type       = std::uint64_t;
+    using error_entry     = std::pair<size_type, E>;
+
+    using reference       = basic_reference<false>;
+    using const_reference = basic_reference<true>;
+    using iterator        = basic_iterator<false>;
+    using const_iterator  = basic_iterator<true>;
+
+    enum { word_bits = 64 };
+
+    expected_vector() = default;
+
+    template< typename InputIt >
+    expected_vector( InputIt first, InputIt last )
+    {
+        append( first, last );
+    }
+
+    // capacity:
+
+    size_type size() const noexcept
+    {
+        return m_values.size();
+    }
+
+    bool empty() const noexcept
+    {
+        return m_values.empty();
+    }
+
+    size_type error_count() const noexcept
+    {
+        return m_errors.size();
+    }
+
+    size_type value_count() const noexcept
+    {
+        return size() - error_count();
+    }
+
+    void reserve( size_type n )
+    {
+        m_values.reserve( n );
+        m_valid.reserve( word_count_for( n ) );
+    }
+
+    void reserve_errors( size_type n )
+    {
+        m_errors.reserve( n );
+    }
+
+    // modifiers:
+
+    void clear() noexcept
+    {
+        m_values.clear();
+        m_valid.clear();
+        m_errors.clear();
+    }
+
+    void push_back( value_type const & e )
+    {
+        if ( e ) push_back( *e );
+        else     emplace_error( e.error() );
+    }
+
+    void push_back( value_type && e )
+    {
+        if ( e ) push_back( std::move( *e ) );
+        else     emplace_error( std::move( e.error() ) );
+    }
+
+    void push_back( T const & v )
+    {
+        emplace_back( v );
+    }
+
+    void push_back( T && v )
+    {
+        emplace_back( std::move( v ) );
+    }
+
+    template< typename G >
+    void push_back( nonstd::unexpected_type<G> const & u )
+    {
+        emplace_error( u.value() );
+    }
+
+    template< typename G >
+    void push_back( nonstd::unexpected_type<G> && u )
+    {
+        emplace_error( std::move( u.value() ) );
+    }
+
+    // the operations that may throw come before push_bit(), which cannot,
+    // so that a throwing append leaves the container as it was.
+
+    template< typename... Args >
+    T & emplace_back( Args&&... args )
+    {
+        reserve_bit();
+        m_values.emplace_back( std::forward<Args>( args )... );
+        push_bit( true );
+        return m_values.back();
+    }
+
+    template< typename... Args >
+    E & emplace_error( Args&&... args )
+    {
+        reserve_bit();
+        m_errors.emplace_back( std::piecewise_construct, std::forward_as_tuple( size() ), std::forward_as_tuple( std::forward<Args>( args )... ) );
+        emplace_placeholder();
+        push_bit( false );
+        return m_errors.back().second;
+    }
+
+    /// append a range of expected<T,E>, moving from it if it yields r-values.
+
+    template< typename InputIt >
+    void append( InputIt first, InputIt last )
+    {
+        reserve_for( first, last, typename std::iterator_traits<InputIt>::iterator_category() );
+
+        for ( ; first != last; ++first )
+        {
+            push_back( *first );
+        }
+    }
+
+    /// append a range of values, setting presence bits a word at a time.
+
+    template< typename InputIt >
+    void append_values( InputIt first, InputIt last )
+    {
+        const size_type pos = size();
+        m_values.insert( m_values.end(), first, last );
+
+#if nsel_CONFIG_NO_EXCEPTIONS
+        set_bits( pos, size() );
+#else
+        try
+        {
+            set_bits( pos, size() );
+        }
+        catch (...)
+        {
+            while ( m_values.size() != pos )
+                m_values.pop_back();
+            throw;
+        }
+#endif
+    }
+
+    // element access:
+
+    reference operator[]( size_type pos ) noexcept
+    {
+        return reference( this, pos );
+    }
+
+    const_reference operator[]( size_type pos ) const noexcept
+    {
+        return const_reference( this, pos );
+    }
+
+    reference at( size_type pos )
+    {
+        return check( pos ), (*this)[ pos ];
+    }
+
+    const_reference at( size_type pos ) const
+    {
+        return check( pos ), (*this)[ pos ];
+    }
+
+    bool has_value( size_type pos ) const noexcept
+    {
+        return ( m_valid[ pos / word_bits ] >> ( pos % word_bits ) ) & 1u;
+    }
+
+    T & value( size_type pos )
+    {
+        return ensure_value( pos ), m_values[ pos ];
+    }
+
+    T const & value( size_type pos ) const
+    {
+        return ensure_value( pos ), m_values[ pos ];
+    }
+
+    E & error( size_type pos )
+    {
+        return assert( ! has_value( pos ) ), find_error( pos )->second;
+    }
+
+    E const & error( size_type pos ) const
+    {
+        return assert( ! has_value( pos ) ), find_error( pos )->second;
+    }
+
+    value_type get( size_type pos ) const
+    {
+        return has_value( pos ) ? value_type( m_values[ pos ] ) : value_type( unexpect, error( pos ) );
+    }
+
+    // raw layout access:
+
+    T * value_data() noexcept
+    {
+        return m_values.data();
+    }
+
+    T const * value_data() const noexcept
+    {
+        return m_values.data();
+    }
+
+    word_type const * validity_data() const noexcept
+    {
+        return m_valid.data();
+    }
+
+    size_type word_count() const noexcept
+    {
+        return m_valid.size();
+    }
+
+    std::vector<error_entry> const & errors() const noexcept
+    {
+        return m_errors;
+    }
+
+    // iterators:
+
+    iterator begin() noexcept
+    {
+        return iterator( this, 0 );
+    }
+
+    iterator end() noexcept
+    {
+        return iterator( this, size() );
+    }
+
+    const_iterator begin() const noexcept
+    {
+        return const_iterator( this, 0 );
+    }
+
+    const_iterator end() const noexcept
+    {
+        return const_iterator( this, size() );
+    }
+
+    const_iterator cbegin() const noexcept
+    {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept
+    {
+        return end();
+    }
+
+    void swap( expected_vector & other ) noexcept
+    {
+        m_values.swap( other.m_values );
+        m_valid .swap( other.m_valid  );
+        m_errors.swap( other.m_errors );
+    }
+
+private:
+    static size_type word_count_for( size_type n ) noexcept
+    {
+        return ( n + word_bits - 1 ) / word_bits;
+    }
+
+    template< typename InputIt >
+    void reserve_for( InputIt, InputIt, std::input_iterator_tag )
+    {}
+
+    template< typename ForwardIt >
+    void reserve_for( ForwardIt first, ForwardIt last, std::forward_iterator_tag )
+    {
+        reserve( size() + static_cast<size_type>( std::distance( first, last ) ) );
+    }
+
+    /// make room for the presence bit of one more element, growing the
+    /// bitmap geometrically.
+
+    void reserve_bit()
+    {
+        const size_type words = word_count_for( size() + 1 );
+
+        if ( words > m_valid.capacity() )
+            m_valid.reserve( (std::max)( words, 2 * m_valid.capacity() ) );
+    }
+
+    /// append the value slot of an error; drop the error entry if that throws.
+
+    void emplace_placeholder()
+    {
+#if nsel_CONFIG_NO_EXCEPTIONS
+        m_values.emplace_back();
+#else
+        try
+        {
+            m_values.emplace_back();
+        }
+        catch (...)
+        {
+            m_errors.pop_back();
+            throw;
+        }
+#endif
+    }
+
+    /// after reserve_bit().
+
+    void push_bit( bool bit ) noexcept
+    {
+        const size_type pos = size() - 1;
+
+        if ( pos % word_bits == 0 )
+        {
+            m_valid.push_back( 0 );
+        }
+        m_valid.back() |= word_type( bit ) << ( pos % word_bits );
+    }
+
+    /// set bits [first, last); the bitmap covers [0, first).
+
+    void set_bits( size_type first, size_type last )
+    {
+        m_valid.resize( word_count_for( last ), 0 );
+
+        for ( size_type pos = first; pos != last; )
+        {
+            const size_type offset = pos % word_bits;
+            const size_type n      = (std::min)( size_type( word_bits ) - offset, last - pos );
+            const word_type mask   = n == word_bits ? ~word_type( 0 ) : ( ( word_type( 1 ) << n ) - 1 ) << offset;
+
+            m_valid[ pos / word_bits ] |= mask;
+            pos += n;
+        }
+    }
+
+    void check( size_type pos ) const
+    {
+        if ( pos >= size() )
+        {
+#if nsel_CONFIG_NO_EXCEPTIONS
+            assert( false && "expected_vector::at(): index out of range" );
+#else
+            throw std::out_of_range( "expected_vector::at(): index out of range" );
+#endif
+        }
+    }
+
+    void ensure_value( size_type pos ) const
+    {
+        if ( ! has_value( pos ) )
+        {
+            error_traits<E>::rethrow( find_error( pos )->second );
+        }
+    }
+
+    typename std::vector<error_entry>::iterator find_error( size_type pos )
+    {
+        return std::lower_bound( m_errors.begin(), m_errors.end(), pos, index_less() );
+    }
+
+    typename std::vector<error_entry>::const_iterator find_error( size_type pos ) const
+    {
+        return std::lower_bound( m_errors.begin(), m_errors.end(), pos, index_less() );
+    }
+
+    struct index_less
+    {
+        bool operator()( error_entry const & entry, size_type pos ) const
+        {
+            return entry.first < pos;
+        }
+    };
+
+    /// proxy to element: behaves like expected<T&,E&>.
+
+    template< bool IsConst >
+    class basic_reference
+    {
+        friend class expected_vector;
+        template< bool > friend class basic_reference;
+
+        using container = typename std::conditional<IsConst, expected_vector const, expected_vector>::type;
+        using value_ref = typename std::conditional<IsConst, T const &, T &>::type;
+        using error_ref = typename std::conditional<IsConst, E const &, E &>::type;
+
+    public:
+        basic_reference( basic_reference<false> const & other ) noexcept
+            : m_vec( other.m_vec ), m_pos( other.m_pos )
+        {}
+
+        explicit operator bool() const noexcept
+        {
+            return has_value();
+        }
+
+        bool has_value() const noexcept
+        {
+            return m_vec->has_value( m_pos );
+        }
+
+        value_ref value() const
+        {
+            return m_vec->value( m_pos );
+        }
+
+        value_ref operator*() const
+        {
+            return assert( has_value() ), m_vec->m_values[ m_pos ];
+        }
+
+        typename std::remove_reference<value_ref>::type * operator->() const
+        {
+            return &**this;
+        }
+
+        error_ref error() const
+        {
+            return m_vec->error( m_pos );
+        }
+
+        template< typename U >
+        T value_or( U && v ) const
+        {
+            return has_value() ? **this : static_cast<T>( std::forward<U>( v ) );
+        }
+
+        size_type index() const noexcept
+        {
+            return m_pos;
+        }
+
+        operator value_type() const
+        {
+            return m_vec->get( m_pos );
+        }
+
+    private:
+        basic_reference( container * vec, size_type pos ) noexcept
+            : m_vec( vec ), m_pos( pos )
+        {}
+
+        container * m_vec;
+        size_type   m_pos;
+    };
+
+    /// random access iterator yielding element proxies, like std::vector<bool>.
+
+    template< bool IsConst >
+    class basic_iterator
+    {
+        friend class expected_vector;
+        template< bool > friend class basic_iterator;
+
+        using container = typename std::conditional<IsConst, expected_vector const, expected_vector>::type;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type        = typename expected_vector::value_type;
+        using difference_type   = std::ptrdiff_t;
+        using reference         = basic_reference<IsConst>;
+        using pointer           = void;
+
+        basic_iterator() noexcept
+            : m_vec(), m_pos()
+        {}
+
+        basic_iterator( basic_iterator<false> const & other ) noexcept
+            : m_vec( other.m_vec ), m_pos( other.m_pos )
+        {}
+
+        reference operator*() const noexcept
+        {
+            return reference( m_vec, m_pos );
+        }
+
+        reference operator[]( difference_type n ) const noexcept
+        {
+            return *( *this + n );
+        }
+
+        basic_iterator & operator++() noexcept { ++m_pos; return *this; }
+        basic_iterator & operator--() noexcept { --m_pos; return *this; }
+
+        basic_iterator operator++( int ) noexcept { basic_iterator tmp( *this ); ++*this; return tmp; }
+        basic_iterator operator--( int ) noexcept { basic_iterator tmp( *this ); --*this; return tmp; }
+
+        basic_iterator & operator+=( difference_type n ) noexcept { m_pos = size_type( difference_type( m_pos ) + n ); return *this; }
+        basic_iterator & operator-=( difference_type n ) noexcept { return *this += -n; }
+
+        friend basic_iterator operator+( basic_iterator it, difference_type n ) noexcept { return it += n; }
+        friend basic_iterator operator+( difference_type n, basic_iterator it ) noexcept { return it += n; }
+        friend basic_iterator operator-( basic_iterator it, difference_type n ) noexcept { return it -= n; }
+
+        friend difference_type operator-( basic_iterator const & x, basic_iterator const & y ) noexcept
+        {
+            return difference_type( x.m_pos ) - difference_type( y.m_pos );
+        }
+
+        friend bool operator==( basic_iterator const & x, basic_iterator const & y ) noexcept { return x.m_pos == y.m_pos; }
+        friend bool operator!=( basic_iterator const & x, basic_iterator const & y ) noexcept { return x.m_pos != y.m_pos; }
+        friend bool operator< ( basic_iterator const & x, basic_iterator const & y ) noexcept { return x.m_pos <  y.m_pos; }
+        friend bool operator> ( basic_iterator const & x, basic_iterator const & y ) noexcept { return x.m_pos >  y.m_pos; }
+        friend bool operator<=( basic_iterator const & x, basic_iterator const & y ) noexcept { return x.m_pos <= y.m_pos; }
+        friend bool operator>=( basic_iterator const & x, basic_iterator const & y ) noexcept { return x.m_pos >= y.m_pos; }
+
+    private:
+        basic_iterator( container * vec, size_type pos ) noexcept
+            : m_vec( vec ), m_pos( pos )
+        {}
+
+        container * m_vec;
+        size_type   m_pos;
+    };
+
+private:
+    std::vector<T>           m_values;
+    std::vector<word_type>   m_valid;
+    std::vector<error_entry> m_errors;
+};
+
+template< typename T, typename E >
+void swap( expected_vector<T,E> & x, expected_vector<T,E> & y ) noexcept
+{
+    x.swap( y );
+}
+
+}} // namespace nonstd::expected_lite
+
+#endif // NONSTD_EXPECTED_VECTOR_LITE_HPP
@@ -0,0 +1,45 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// https://github.com/martinmoene/expected-lite
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Use expected via import nonstd.expected, without including the header;
+// exits with a failure when an operation does not behave as expected.
+
+import nonstd.expected;
+
+#include <cstdlib>
+#include <string>
+
+namespace {
+
+nonstd::expected<int, std::string> parse( char const * text )
+{
+    if ( text[0] < '0' || text[0] > '9' )
+        return nonstd::make_unexpected( std::string( "not a digit: " ) + text );
+
+    return text[0] - '0';
+}
+
+} // anonymous namespace
+
+int main()
+{
+    auto const good = parse( "7" );
+    auto const bad  = parse( "x" );
+
+    nonstd::expected<int, std::string> copy = good;
+    nonstd::expected<void, std::string> done;
+
+    const bool passed =
+        good.has_value() && *good == 7 && good.value_or( 0 ) == 7
+        && ! bad && bad.error() == "not a digit: x" && bad.value_or( 0 ) == 0
+        && copy == good && copy != bad && copy == 7
+        && done.has_value();
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// end of file
@@ -0,0 +1,77 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// https://github.com/martinmoene/expected-lite
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Module nonstd.expected: the names of nonstd/expected.hpp, parsed once.
+// This version targets C++20 and later, see module/CMakeLists.txt.
+//
+// Configuration macros such as nsel_CONFIG_SELECT_EXPECTED, nsel_P0323R and
+// nsel_CONFIG_NO_EXCEPTIONS take effect when compiling this module unit, not
+// in the units that import it. Macros, such as nsel_USES_STD_EXPECTED, are not
+// exported; include the header where they are needed.
+
+module;
+
+#include "nonstd/expected.hpp"
+
+export module nonstd.expected;
+
+export namespace nonstd {
+
+using nonstd::expected;
+
+#if nsel_USES_STD_EXPECTED
+
+using nonstd::unexpected;
+using nonstd::unexpect_t;
+using nonstd::unexpect;
+using nonstd::bad_expected_access;
+
+#else // nsel_USES_STD_EXPECTED
+
+using nonstd::unexpected_type;
+using nonstd::unexpected;
+using nonstd::make_unexpected;
+
+using nonstd::unexpect_t;
+using nonstd::unexpect;
+using nonstd::in_place_unexpected_t;
+using nonstd::in_place_unexpected;
+
+using nonstd::bad_expected_access;
+using nonstd::error_traits;
+
+using nonstd::boxed;
+using nonstd::is_boxed_error;
+using nonstd::boxed_error_allocator;
+
+#if nsel_P0323R <= 3
+using nonstd::is_unexpected;
+using nonstd::make_unexpected_from_current_exception;
+using nonstd::make_expected;
+using nonstd::make_expected_from_current_exception;
+using nonstd::make_expected_from_exception;
+using nonstd::make_expected_from_error;
+using nonstd::make_expected_from_call;
+#endif
+
+// comparison and swap, also found via argument-dependent lookup:
+
+using nonstd::expected_lite::operator==;
+using nonstd::expected_lite::operator!=;
+#if nsel_P0323R <= 2
+using nonstd::expected_lite::operator<;
+using nonstd::expected_lite::operator>;
+using nonstd::expected_lite::operator<=;
+using nonstd::expected_lite::operator>=;
+#endif
+using nonstd::expected_lite::swap;
+
+#endif // nsel_USES_STD_EXPECTED
+
+} // export namespace nonstd
+
+// end of file
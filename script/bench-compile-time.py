@@ -0,0 +1,167 @@
+#!/usr/bin/env python
+#
+# Copyright 2016-2020 by Martin Moene
+#
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+#
+# script/bench-compile-time.py, Python 3.4 and later
+#
+# Generate a translation unit with the given number of distinct instantiations
+# of expected<T,E> and expected<void,E> and measure the front-end time of
+# compiling it (syntax only), the best of the given number of runs.
+#
+
+from __future__ import print_function
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+# Configuration:
+
+cfg_compiler = 'g++'
+cfg_count    = 200
+cfg_runs     = 3
+cfg_std      = [ 'c++11', 'c++17', 'c++20' ]
+
+tpl_header = """\
+// generated by script/bench-compile-time.py
+
+#include "nonstd/expected.hpp"
+
+#include <utility>
+"""
+
+tpl_instantiation = """
+struct value{n} {{ int v; }};
+struct error{n} {{ int e; }};
+
+inline bool operator==( value{n} a, value{n} b ) {{ return a.v == b.v; }}
+inline bool operator==( error{n} a, error{n} b ) {{ return a.e == b.e; }}
+
+nonstd::expected<value{n}, error{n}> make{n}( int x )
+{{
+    if ( x ) return value{n}{{ x }};
+    return nonstd::make_unexpected( error{n}{{ x }} );
+}}
+
+int use{n}( int x )
+{{
+    auto r = make{n}( x );
+    auto c = r;
+    c = r;
+    nonstd::expected<value{n}, error{n}> m( std::move( c ) );
+    m.swap( c );
+    nonstd::expected<void, error{n}> v;
+    v = nonstd::make_unexpected( error{n}{{ x }} );
+    return r ? r->v + r.value_or( value{n}{{ 0 }} ).v + ( m == c ) : r.error().e + ( v ? 1 : 0 );
+}}
+"""
+
+# End configuration.
+
+def project_folder():
+    """Project root"""
+    return os.path.normpath( os.path.join( os.path.dirname( os.path.abspath(__file__) ), '..' ) )
+
+def generateSource( count ):
+    """Return the source of a translation unit with count instantiations"""
+    return tpl_header + ''.join( tpl_instantiation.format( n=n ) for n in range( count ) )
+
+def compileTime( path, std, args ):
+    """Return the best time in seconds of compiling path, syntax only"""
+    cmd = [ args.compiler, '-std=' + std, '-fsyntax-only', '-I' + args.include ] + args.define + [ path ]
+    if args.verbose:
+        print( "> {}".format( ' '.join( cmd ) ) )
+    best = None
+    for _ in range( args.runs ):
+        start = time.time()
+        if subprocess.call( cmd ) != 0:
+            sys.exit( "bench-compile-time: compilation failed" )
+        elapsed = time.time() - start
+        best = elapsed if best is None else min( best, elapsed )
+    return best
+
+def benchCompileTime( args ):
+    """Generate the translation unit and report its compile time per standard"""
+    handle, path = tempfile.mkstemp( suffix='.cpp' )
+    try:
+        with os.fdopen( handle, 'w' ) as out:
+            out.write( generateSource( args.count ) )
+        for std in args.std:
+            seconds = compileTime( path, std, args )
+            print( "{compiler} -std={std}, {count} instantiations: {seconds:.3f} s, {ms:.2f} ms per instantiation".
+                format( compiler=args.compiler, std=std, count=args.count, seconds=seconds, ms=1000 * seconds / args.count ) )
+    finally:
+        os.remove( path )
+
+def benchCompileTimeFromCommandLine():
+    """Collect arguments from the commandline and measure compile time."""
+    parser = argparse.ArgumentParser(
+        description='Measure the front-end time of compiling many distinct instantiations of expected.',
+        epilog="""""",
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+
+    parser.add_argument(
+        '-v', '--verbose',
+        action='count',
+        default=0,
+        help='level of progress reporting')
+
+    parser.add_argument(
+        '--compiler',
+        metavar='c',
+        type=str,
+        default=cfg_compiler,
+        help='compiler to use, GNU or Clang command line')
+
+    parser.add_argument(
+        '--count',
+        metavar='n',
+        type=int,
+        default=cfg_count,
+        help='number of distinct instantiations')
+
+    parser.add_argument(
+        '--runs',
+        metavar='r',
+        type=int,
+        default=cfg_runs,
+        help='number of runs, best is reported')
+
+    parser.add_argument(
+        '--std',
+        metavar='s',
+        type=str,
+        nargs='+',
+        default=cfg_std,
+        help='language standards to compile for')
+
+    parser.add_argument(
+        '--include',
+        metavar='i',
+        type=str,
+        default=os.path.join( project_folder(), 'include' ),
+        help='folder with nonstd/expected.hpp, e.g. to compare with another version')
+
+    parser.add_argument(
+        '-D', '--define',
+        metavar='d',
+        type=str,
+        action='append',
+        default=[],
+        help='macro definition passed to the compiler, e.g. -D nsel_P0323R=2')
+
+    args = parser.parse_args()
+    args.define = [ '-D' + d for d in args.define ]
+
+    benchCompileTime( args )
+
+if __name__ == '__main__':
+    benchCompileTimeFromCommandLine()
+
+# end of file
@@ -0,0 +1,52 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// https://github.com/martinmoene/expected-lite
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// expected-lite-instantiations: one canonical copy of common specializations
+// of expected and of the rethrow helpers, declared extern in expected.hpp
+// with nsel_CONFIG_EXTERN_INSTANTIATIONS=1.
+
+#include "nonstd/expected.hpp"
+
+#if !nsel_USES_STD_EXPECTED
+
+#if !nsel_CONFIG_EXTERN_INSTANTIATIONS
+# error expected-lite-instantiations: compile with nsel_CONFIG_EXTERN_INSTANTIATIONS=1
+#endif
+
+#include <string>
+
+namespace nonstd { namespace expected_lite {
+
+// rethrow helpers:
+
+#if !nsel_CONFIG_NO_EXCEPTIONS
+
+void error_traits< std::exception_ptr >::rethrow( std::exception_ptr const & e )
+{
+    std::rethrow_exception( e );
+}
+
+void error_traits< std::error_code >::rethrow( std::error_code const & e )
+{
+    throw std::system_error( e );
+}
+
+#endif // nsel_CONFIG_NO_EXCEPTIONS
+
+// common specializations:
+
+template class unexpected_type< std::error_code >;
+
+template class expected< void,        std::error_code >;
+template class expected< int,         std::error_code >;
+template class expected< std::string, std::error_code >;
+
+}} // namespace nonstd::expected_lite
+
+#endif // nsel_USES_STD_EXPECTED
+
+// end of file
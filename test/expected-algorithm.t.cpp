@@ -0,0 +1,293 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_algorithm.hpp"
+
+#include <list>
+#include <set>
+#include <string>
+
+using namespace nonstd;
+
+namespace {
+
+// counts copies of itself:
+
+struct Tracked
+{
+    static int copies;
+
+    int v;
+
+    Tracked( int v_ = 0 ) : v( v_ ) {}
+    Tracked( Tracked const & other ) : v( other.v ) { ++copies; }
+    Tracked( Tracked && other ) noexcept : v( other.v ) { other.v = -1; }
+    Tracked & operator=( Tracked const & other ) { v = other.v; ++copies; return *this; }
+    Tracked & operator=( Tracked && other ) noexcept { v = other.v; other.v = -1; return *this; }
+};
+
+int Tracked::copies = 0;
+
+std::vector< expected<int, std::string> > make_results( int n, int error_at = -1 )
+{
+    std::vector< expected<int, std::string> > r;
+
+    for ( int i = 0; i < n; ++i )
+    {
+        if ( i == error_at ) r.push_back( make_unexpected( "error " + std::to_string( i ) ) );
+        else                 r.push_back( i );
+    }
+    return r;
+}
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// collect(), collect_into()
+
+CASE( "collect: Allows to turn a range of values into expected of vector" )
+{
+    auto r = collect( make_results( 5 ) );
+
+    EXPECT( r.has_value() );
+    EXPECT( *r == ( std::vector<int>{ 0, 1, 2, 3, 4 } ) );
+}
+
+CASE( "collect: Yields the first error of a range" )
+{
+    auto src = make_results( 5, 2 );
+    src[4] = make_unexpected( std::string( "later" ) );
+
+    auto r = collect( src );
+
+    EXPECT( ! r.has_value() );
+    EXPECT( r.error() == "error 2" );
+}
+
+CASE( "collect: Allows a range of expected<void,E>" )
+{
+    std::list< expected<void, int> > src( 3 );
+
+    EXPECT( collect( src ).has_value() );
+
+    src.push_back( make_unexpected( 7 ) );
+
+    EXPECT( collect( src ).error() == 7 );
+}
+
+CASE( "collect: Moves the elements of an rvalue range, copies those of an lvalue range" )
+{
+    std::vector< expected<Tracked, int> > src;
+    src.push_back( Tracked( 1 ) );
+    src.push_back( Tracked( 2 ) );
+
+    Tracked::copies = 0;
+    auto a = collect( src );
+
+    EXPECT( Tracked::copies == 2 );
+    EXPECT( src[0]->v == 1 );
+
+    Tracked::copies = 0;
+    auto b = collect( std::move( src ) );
+
+    EXPECT( Tracked::copies == 0 );
+    EXPECT( (*b)[1].v == 2 );
+}
+
+CASE( "collect_into: Allows to append values to a container" )
+{
+    std::set<int> s = { 10 };
+
+    auto r = collect_into( s, make_results( 3 ) );
+
+    EXPECT( r.has_value() );
+    EXPECT( s == ( std::set<int>{ 0, 1, 2, 10 } ) );
+}
+
+CASE( "collect_into: Reserves room for a sized range" )
+{
+    std::vector<int> v;
+
+    EXPECT( collect_into( v, make_results( 100 ) ).has_value() );
+    EXPECT( v.capacity() == 100u );
+}
+
+CASE( "collect_into: Stops at the first error, keeping the values before it" )
+{
+    std::vector<int> v;
+
+    auto r = collect_into( v, make_results( 10, 4 ) );
+
+    EXPECT( r.error() == "error 4" );
+    EXPECT( v == ( std::vector<int>{ 0, 1, 2, 3 } ) );
+}
+
+// -----------------------------------------------------------------------
+// partition_results()
+
+CASE( "partition_results: Allows to split a range into values and indexed errors" )
+{
+    auto src = make_results( 8, 3 );
+    src[6] = make_unexpected( std::string( "error 6" ) );
+
+    std::vector<int> values;
+    std::vector< std::pair<std::size_t, std::string> > errors;
+
+    partition_results( src, values, errors );
+
+    EXPECT( values == ( std::vector<int>{ 0, 1, 2, 4, 5, 7 } ) );
+    EXPECT( errors.size() == 2u );
+    EXPECT( errors[0].first == 3u );
+    EXPECT( errors[0].second == "error 3" );
+    EXPECT( errors[1].first == 6u );
+    EXPECT( errors[1].second == "error 6" );
+}
+
+CASE( "partition_results: Allows to write into contiguous storage via iterators" )
+{
+    auto src = make_results( 5, 1 );
+
+    int values[5] = {};
+    std::pair<std::size_t, std::string> errors[5];
+
+    auto r = partition_results( src, values, errors );
+
+    EXPECT( r.values == values + 4 );
+    EXPECT( r.errors == errors + 1 );
+    EXPECT( values[3] == 4 );
+    EXPECT( errors[0].first == 1u );
+}
+
+CASE( "partition_results: Reserves the exact number of values and errors after a counting pass" )
+{
+    auto src = make_results( 100, 10 );
+
+    std::vector<int> values;
+    std::vector< std::pair<std::size_t, std::string> > errors;
+
+    partition_results( src, values, errors, partition_reserve::count );
+
+    EXPECT( values.capacity() == 99u );
+    EXPECT( errors.capacity() ==  1u );
+}
+
+CASE( "partition_results: Reserves room for all elements as values on request" )
+{
+    auto src = make_results( 100, 10 );
+
+    std::vector<int> values;
+    std::vector< std::pair<std::size_t, std::string> > errors;
+
+    partition_results( src, values, errors, partition_reserve::size );
+
+    EXPECT( values.capacity() == 100u );
+    EXPECT( values.size() == 99u );
+}
+
+CASE( "partition_results: Moves the elements of an rvalue range" )
+{
+    std::vector< expected<Tracked, Tracked> > src;
+    src.push_back( Tracked( 1 ) );
+    src.push_back( make_unexpected( Tracked( 2 ) ) );
+
+    std::vector<Tracked> values;
+    std::vector< std::pair<std::size_t, Tracked> > errors;
+
+    Tracked::copies = 0;
+    partition_results( std::move( src ), values, errors );
+
+    EXPECT( Tracked::copies == 0 );
+    EXPECT( values[0].v == 1 );
+    EXPECT( errors[0].second.v == 2 );
+}
+
+// -----------------------------------------------------------------------
+// zip(), when_all(), zip_with()
+
+CASE( "zip: Allows to combine the values of several expected into a tuple" )
+{
+    expected<int, std::string> a( 1 );
+    expected<std::string, std::string> b( std::string( "two" ) );
+    expected<double, std::string> c( 3.0 );
+
+    auto r = zip( a, b, c );
+
+    EXPECT( r.has_value() );
+    EXPECT( std::get<0>( *r ) == 1 );
+    EXPECT( std::get<1>( *r ) == "two" );
+    EXPECT( std::get<2>( *r ) == 3.0 );
+}
+
+CASE( "zip: Yields the error of the first expected without a value" )
+{
+    expected<int, std::string> a = 1;
+    expected<int, std::string> b = make_unexpected( std::string( "b" ) );
+    expected<int, std::string> c = make_unexpected( std::string( "c" ) );
+
+    EXPECT( zip( a, b, c ).error() == "b" );
+    EXPECT( zip( c, b ).error() == "c" );
+    EXPECT( zip( b ).error() == "b" );
+}
+
+CASE( "zip: Moves the values of rvalue arguments into the tuple" )
+{
+    expected<Tracked, int> a = Tracked( 1 );
+    expected<Tracked, int> b = Tracked( 2 );
+
+    Tracked::copies = 0;
+    auto r = zip( std::move( a ), std::move( b ) );
+
+    EXPECT( Tracked::copies == 0 );
+    EXPECT( std::get<1>( *r ).v == 2 );
+}
+
+CASE( "when_all: Allows to combine the values of several expected into a tuple" )
+{
+    expected<int, int> a = 1;
+    expected<char, int> b = 'b';
+
+    auto r = when_all( a, b );
+
+    EXPECT( *r == std::make_tuple( 1, 'b' ) );
+}
+
+CASE( "zip_with: Allows to apply a function to the values of several expected" )
+{
+    expected<int, std::string> a = 6;
+    expected<int, std::string> b = 7;
+
+    auto r = zip_with( []( int x, int y ) { return x * y; }, a, b );
+
+    EXPECT( r.value() == 42 );
+}
+
+CASE( "zip_with: Yields the error of the first expected without a value, without calling the function" )
+{
+    expected<int, std::string> a = 6;
+    expected<int, std::string> b = make_unexpected( std::string( "b" ) );
+    bool called = false;
+
+    auto r = zip_with( [&called]( int x, int y ) { called = true; return x * y; }, a, b );
+
+    EXPECT( r.error() == "b" );
+    EXPECT( ! called );
+}
+
+CASE( "zip_with: Yields expected<void,E> for a function that returns void" )
+{
+    expected<int, int> a = 6;
+    int sum = 0;
+
+    auto r = zip_with( [&sum]( int x ) { sum += x; }, a );
+
+    EXPECT( ( std::is_same< decltype( r ), expected<void, int> >::value ) );
+    EXPECT( r.has_value() );
+    EXPECT( sum == 6 );
+}
+
+// end of file
@@ -0,0 +1,189 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_atomic.hpp"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace nonstd;
+
+namespace {
+
+// three equal fields, to detect a torn read:
+
+struct Triple
+{
+    long long a, b, c;
+
+    explicit Triple( long long x = 0 ) : a( x ), b( x ), c( x ) {}
+
+    bool consistent() const { return a == b && b == c; }
+};
+
+enum class errc : short { busy = 1, down = 2 };
+
+// declared only, as a user of atomic_expected<Config *, errc> may see it:
+
+struct Config;
+struct Opaque;
+
+} // anonymous namespace
+
+namespace nonstd { namespace expected_lite {
+
+template<>
+struct pointee_alignment< Config > : std::integral_constant< std::size_t, alignof(int) > {};
+
+}} // namespace nonstd::expected_lite
+
+// -----------------------------------------------------------------------
+// atomic_expected
+
+CASE( "atomic_expected: Allows to load and store a value and an error" )
+{
+    atomic_expected<int, errc> a;
+
+    EXPECT( a.load().value() == 0 );
+
+    a.store( 42 );
+    EXPECT( a.load().value() == 42 );
+
+    a.store( make_unexpected( errc::down ) );
+    EXPECT( a.load().error() == errc::down );
+
+    a = 7;
+    expected<int, errc> e = a;
+    EXPECT( e.value() == 7 );
+}
+
+CASE( "atomic_expected: Is lock-free if value or error and flag fit in 64 bits" )
+{
+    atomic_expected<int, errc> a;
+    atomic_expected<Triple, int> b;
+
+    EXPECT( a.is_lock_free() );
+    EXPECT( ! b.is_lock_free() );
+    EXPECT( ( ! atomic_expected<Triple, int>::is_always_lock_free ) );
+}
+
+CASE( "atomic_expected: Packs a pointer to an incomplete type into a single word only if its pointee_alignment allows" )
+{
+    EXPECT( sizeof( atomic_expected<Config *, errc> ) == sizeof( std::uint64_t ) );
+    EXPECT( sizeof( atomic_expected<Opaque *, errc> ) > sizeof( std::uint64_t ) );
+    EXPECT( sizeof( atomic_expected<int *, errc> ) == sizeof( std::uint64_t ) );
+    EXPECT( sizeof( atomic_expected<char *, errc> ) > sizeof( std::uint64_t ) );
+}
+
+namespace {
+
+struct Config
+{
+    int version;
+};
+
+} // anonymous namespace
+
+CASE( "atomic_expected: Packs a pointer and an error into a single word" )
+{
+    EXPECT( alignof( Config ) >= pointee_alignment<Config>::value );
+
+    Config config{ 3 };
+    atomic_expected<Config *, errc> a( &config );
+
+    EXPECT( sizeof( a ) == sizeof( std::uint64_t ) );
+    EXPECT( a.is_lock_free() );
+    EXPECT( a.load().value()->version == 3 );
+
+    a.store( nullptr );
+    EXPECT( a.load().value() == nullptr );
+
+    a.store( make_unexpected( errc::down ) );
+    EXPECT( a.load().error() == errc::down );
+
+    expected<Config *, errc> expect = make_unexpected( errc::down );
+    EXPECT( a.compare_exchange_strong( expect, &config ) );
+    EXPECT( a.load().value() == &config );
+}
+
+CASE( "atomic_expected: Allows to exchange a value for an error" )
+{
+    atomic_expected<long long, int> a( 1 );
+
+    auto previous = a.exchange( make_unexpected( 3 ) );
+
+    EXPECT( previous.value() == 1 );
+    EXPECT( a.load().error() == 3 );
+}
+
+CASE( "atomic_expected: Allows to compare and exchange" )
+{
+    atomic_expected<int, errc> a( 1 );
+    expected<int, errc> expect = 2;
+
+    EXPECT( ! a.compare_exchange_strong( expect, 3 ) );
+    EXPECT( expect.value() == 1 );
+
+    EXPECT( a.compare_exchange_strong( expect, make_unexpected( errc::busy ) ) );
+    EXPECT( a.load().error() == errc::busy );
+
+    expect = make_unexpected( errc::down );
+    EXPECT( ! a.compare_exchange_weak( expect, 4 ) );
+    EXPECT( expect.error() == errc::busy );
+}
+
+CASE( "atomic_expected: Allows concurrent compare and exchange in a single word" )
+{
+    atomic_expected<int, errc> a( 0 );
+    std::vector<std::thread> threads;
+
+    for ( int t = 0; t < 4; ++t )
+    {
+        threads.emplace_back( [&a]
+        {
+            for ( int i = 0; i < 1000; ++i )
+            {
+                expected<int, errc> current = a.load();
+                while ( ! a.compare_exchange_weak( current, *current + 1 ) ) {}
+            }
+        } );
+    }
+
+    for ( auto & t : threads ) t.join();
+
+    EXPECT( a.load().value() == 4000 );
+}
+
+CASE( "atomic_expected: Never yields a torn value of several words" )
+{
+    atomic_expected<Triple, int> a;
+    bool torn = false;
+
+    std::thread writer( [&a]
+    {
+        for ( long long i = 1; i <= 2000; ++i )
+        {
+            if ( i % 3 ) a.store( Triple( i ) );
+            else         a.store( make_unexpected( static_cast<int>( i ) ) );
+        }
+    } );
+
+    for ( int i = 0; i < 2000; ++i )
+    {
+        auto e = a.load();
+        torn = torn || ( e.has_value() && ! e->consistent() );
+    }
+
+    writer.join();
+
+    EXPECT( ! torn );
+    EXPECT( a.load().value().a == 2000 );
+}
+
+// end of file
@@ -0,0 +1,101 @@
+# Copyright 2016-2018 by Martin Moene
+#
+# https://github.com/martinmoene/expected-lite
+#
+# Distributed under the Boost Software License, Version 1.0.
+# (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+#
+# Check the optimized x86-64 code of the functions in expected-codegen.cpp
+# against the limits stated there: at most the given number of instructions,
+# no call and no use of the stack (no stack spills).
+#
+# Usage: cmake -DOBJDUMP=objdump -DSOURCE=expected-codegen.cpp -DOBJECT=object-file -P expected-codegen.cmake
+
+foreach( var OBJDUMP SOURCE OBJECT )
+    if( NOT DEFINED ${var} )
+        message( FATAL_ERROR "codegen: define ${var}" )
+    endif()
+endforeach()
+
+execute_process(
+    COMMAND ${OBJDUMP} -d --no-show-raw-insn ${OBJECT}
+    OUTPUT_VARIABLE listing
+    RESULT_VARIABLE result )
+
+if( NOT result EQUAL 0 )
+    message( FATAL_ERROR "codegen: ${OBJDUMP} failed on '${OBJECT}'" )
+endif()
+
+# count instructions per function; padding does not count:
+
+string( REPLACE ";" "," listing "${listing}" )
+string( REPLACE "\n" ";" lines "${listing}" )
+
+set( function "" )
+
+foreach( line ${lines} )
+    if( line MATCHES "^[0-9a-f]+ <([^>]+)>:$" )
+        set( function ${CMAKE_MATCH_1} )
+        set( count_${function} 0 )
+        set( calls_${function} "" )
+        set( stack_${function} "" )
+    elseif( function AND line MATCHES "^ +[0-9a-f]+:\t(.*)$" )
+        set( insn "${CMAKE_MATCH_1}" )
+
+        if( insn MATCHES "^(nop|xchg +%ax,%ax|data16|cs nop|endbr64)" )
+            continue()
+        endif()
+
+        math( EXPR count_${function} "${count_${function}} + 1" )
+
+        if( insn MATCHES "^call" )
+            list( APPEND calls_${function} "${insn}" )
+        endif()
+        if( insn MATCHES "^(push|pop)|%rsp|%rbp" )
+            list( APPEND stack_${function} "${insn}" )
+        endif()
+    endif()
+endforeach()
+
+# check each function against its limit:
+
+file( STRINGS ${SOURCE} limits REGEX "^// codegen: [A-Za-z_0-9]+, at most [0-9]+ instructions" )
+
+if( NOT limits )
+    message( FATAL_ERROR "codegen: no limits found in '${SOURCE}'" )
+endif()
+
+set( failed FALSE )
+
+foreach( limit ${limits} )
+    string( REGEX MATCH "codegen: ([A-Za-z_0-9]+), at most ([0-9]+)" unused "${limit}" )
+    set( name ${CMAKE_MATCH_1} )
+    set( most ${CMAKE_MATCH_2} )
+
+    if( NOT DEFINED count_${name} )
+        message( "codegen: ${name}: not found" )
+        set( failed TRUE )
+        continue()
+    endif()
+
+    message( "codegen: ${name}: ${count_${name}} instructions, at most ${most}" )
+
+    if( count_${name} GREATER most )
+        message( "codegen: ${name}: too many instructions" )
+        set( failed TRUE )
+    endif()
+    if( calls_${name} )
+        message( "codegen: ${name}: calls: ${calls_${name}}" )
+        set( failed TRUE )
+    endif()
+    if( stack_${name} )
+        message( "codegen: ${name}: uses the stack: ${stack_${name}}" )
+        set( failed TRUE )
+    endif()
+endforeach()
+
+if( failed )
+    message( FATAL_ERROR "codegen: failed" )
+endif()
+
+# end of file
@@ -0,0 +1,75 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Accessors of expected whose optimized code is checked by test codegen, see
+// expected-codegen.cmake. Compiled with -O2 -DNDEBUG for x86-64, each function
+// below must take at most the number of instructions stated in the comment
+// before it, and must neither call nor use the stack.
+
+#include "nonstd/expected.hpp"
+
+using nonstd::expected;
+
+extern "C" {
+
+// codegen: codegen_deref, at most 2 instructions
+
+int codegen_deref( expected<int, int> const & e )
+{
+    return *e;
+}
+
+// codegen: codegen_error, at most 2 instructions
+
+int codegen_error( expected<int, int> const & e )
+{
+    return e.error();
+}
+
+// codegen: codegen_has_value, at most 2 instructions
+
+bool codegen_has_value( expected<int, int> const & e )
+{
+    return e.has_value();
+}
+
+// codegen: codegen_value_or, at most 5 instructions
+
+int codegen_value_or( expected<int, int> const & e )
+{
+    return e.value_or( 0 );
+}
+
+// codegen: codegen_equal, at most 10 instructions
+
+bool codegen_equal( expected<int, int> const & x, expected<int, int> const & y )
+{
+    return x == y;
+}
+
+// codegen: codegen_equal_value, at most 6 instructions
+
+bool codegen_equal_value( expected<int, int> const & e, int v )
+{
+    return e == v;
+}
+
+// codegen: codegen_copy, at most 6 instructions
+
+expected<int, int> codegen_copy( expected<int, int> const & e )
+{
+    return e;
+}
+
+// codegen: codegen_void_has_value, at most 2 instructions
+
+bool codegen_void_has_value( expected<void, int> const & e )
+{
+    return e.has_value();
+}
+
+} // extern "C"
+
+// end of file
@@ -0,0 +1,204 @@
+// This version targets C++20 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_coroutine.hpp"
+
+#if nsel_HAVE_COROUTINES
+
+// GCC pairs the allocator_arg_t operator new of the promise with its usual
+// operator delete, which releases frames of either origin:
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+# pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+using namespace nonstd;
+
+namespace {
+
+int destructed = 0;
+
+struct Guard
+{
+    ~Guard() { ++destructed; }
+};
+
+expected<int, std::string> parse( std::string const & s )
+{
+    if ( s.empty() || s.find_first_not_of( "0123456789" ) != std::string::npos )
+        return make_unexpected( "not a number: '" + s + "'" );
+    return std::stoi( s );
+}
+
+expected<int, std::string> add( std::string const & a, std::string const & b )
+{
+    Guard guard;
+
+    int x = co_await parse( a );
+    int y = co_await parse( b );
+
+    co_return x + y;
+}
+
+expected<void, std::string> check_positive( int x )
+{
+    if ( x <= 0 )
+        co_await make_unexpected( "not positive: " + std::to_string( x ) );
+    co_return;
+}
+
+expected<std::unique_ptr<int>, std::string> make_unique_int( int x )
+{
+    expected<std::unique_ptr<int>, std::string> e( std::unique_ptr<int>( new int( x ) ) );
+
+    std::unique_ptr<int> p = co_await std::move( e );
+
+    co_return std::move( p );
+}
+
+expected<int, std::string> throwing()
+{
+    co_await parse( "1" );
+    throw std::runtime_error( "bad" );
+}
+
+int allocations = 0;
+int live = 0;
+
+template< typename T >
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    template< typename U >
+    CountingAllocator( CountingAllocator<U> const & ) {}
+
+    T * allocate( std::size_t n ) { ++allocations; ++live; return std::allocator<T>().allocate( n ); }
+    void deallocate( T * p, std::size_t n ) { --live; std::allocator<T>().deallocate( p, n ); }
+};
+
+expected<int, std::string> add_with( std::allocator_arg_t, CountingAllocator<char> const &, std::string const & a, std::string const & b )
+{
+    co_return co_await parse( a ) + co_await parse( b );
+}
+
+expected<int, std::string> rethrowing_with( std::allocator_arg_t, CountingAllocator<char> const & )
+{
+    Guard guard;
+
+    co_await parse( "1" );
+    throw std::runtime_error( "bad" );
+}
+
+expected<int, std::exception_ptr> throwing_with( std::allocator_arg_t, CountingAllocator<char> const & )
+{
+    Guard guard;
+
+    co_await expected<int, std::exception_ptr>( 1 );
+    throw std::runtime_error( "bad" );
+}
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// expected as coroutine type
+
+CASE( "coroutine: Allows co_await on expected to yield its value" )
+{
+    EXPECT( add( "1", "2" ).value() == 3 );
+}
+
+CASE( "coroutine: Returns the error of the first expected co_awaited without a value" )
+{
+    EXPECT( add( "1", "x" ).error().compare( "not a number: 'x'" ) == 0 );
+    EXPECT( add( "y", "x" ).error().compare( "not a number: 'y'" ) == 0 );
+}
+
+CASE( "coroutine: Destroys the locals of a coroutine that returns an error" )
+{
+    destructed = 0;
+
+    (void) add( "1", "x" );
+
+    EXPECT( destructed == 1 );
+}
+
+CASE( "coroutine: Allows co_await on unexpected to return an error" )
+{
+    EXPECT(   check_positive(  1 ).has_value() );
+    EXPECT( ! check_positive( -1 ).has_value() );
+    EXPECT(   check_positive( -1 ).error().compare( "not positive: -1" ) == 0 );
+}
+
+CASE( "coroutine: Allows co_await on an rvalue expected to move its value" )
+{
+    EXPECT( *make_unique_int( 7 ).value() == 7 );
+}
+
+CASE( "coroutine: Propagates an exception thrown in the coroutine" )
+{
+    EXPECT_THROWS_AS( throwing(), std::runtime_error );
+}
+
+CASE( "coroutine: Destroys the locals and frees the frame once of a coroutine that throws" )
+{
+    destructed = 0;
+    allocations = 0;
+    live = 0;
+
+    EXPECT_THROWS_AS( rethrowing_with( std::allocator_arg, CountingAllocator<char>() ), std::runtime_error );
+    EXPECT_THROWS_AS( rethrowing_with( std::allocator_arg, CountingAllocator<char>() ), std::runtime_error );
+
+    EXPECT( destructed == 2 );
+    EXPECT( allocations == 2 );
+    EXPECT( live == 0 );
+
+    EXPECT_THROWS_AS( throwing(), std::runtime_error );
+    EXPECT_THROWS_AS( throwing(), std::runtime_error );
+    EXPECT( add( "1", "2" ).value() == 3 );
+    EXPECT( add( "3", "4" ).value() == 7 );
+}
+
+CASE( "coroutine: Returns an exception thrown in the coroutine as error if the error type is std::exception_ptr" )
+{
+    destructed = 0;
+    allocations = 0;
+    live = 0;
+
+    auto x = throwing_with( std::allocator_arg, CountingAllocator<char>() );
+
+    EXPECT( ! x.has_value() );
+    EXPECT_THROWS_AS( std::rethrow_exception( x.error() ), std::runtime_error );
+    EXPECT( destructed == 1 );
+    EXPECT( allocations == 1 );
+    EXPECT( live == 0 );
+}
+
+CASE( "coroutine: Allows to allocate the frame via a leading allocator_arg_t, allocator pair" )
+{
+    allocations = 0;
+
+    auto r = add_with( std::allocator_arg, CountingAllocator<char>(), "3", "4" );
+    auto e = add_with( std::allocator_arg, CountingAllocator<char>(), "3", "x" );
+
+    EXPECT( r.value() == 7 );
+    EXPECT( e.error().compare( "not a number: 'x'" ) == 0 );
+    EXPECT( allocations == 2 );
+    EXPECT( live == 0 );
+}
+
+#endif // nsel_HAVE_COROUTINES
+
+// end of file
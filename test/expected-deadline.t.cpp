@@ -0,0 +1,136 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_deadline.hpp"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+using namespace nonstd;
+
+namespace {
+
+using clock_type = std::chrono::steady_clock;
+
+expected<int, std::string> answer()
+{
+    return 42;
+}
+
+expected<int, std::string> failure()
+{
+    return make_unexpected( std::string( "failed" ) );
+}
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// call_with_deadline(), cancellable(), stop_check, cancelled_or_timeout
+
+CASE( "call_with_deadline: Yields the value or error of a function that completes in time" )
+{
+    auto v = call_with_deadline( std::chrono::seconds( 10 ), answer );
+    auto e = call_with_deadline( std::chrono::seconds( 10 ), failure );
+
+    EXPECT( v.value() == 42 );
+    EXPECT( e.error().has_error() );
+    EXPECT( e.error().reason() == interruption::none );
+    EXPECT( e.error().error().compare( "failed" ) == 0 );
+}
+
+CASE( "call_with_deadline: Does not call the function once the deadline has passed" )
+{
+    int calls = 0;
+
+    auto r = call_with_deadline( clock_type::now() - std::chrono::seconds( 1 ), [&calls]
+    {
+        ++calls;
+        return expected<void, int>();
+    } );
+
+    EXPECT( calls == 0 );
+    EXPECT( r.error().is_timeout() );
+}
+
+CASE( "call_with_deadline: Yields timeout if the function stops at a stop_check" )
+{
+    int checks = 0;
+
+    auto r = call_with_deadline( std::chrono::milliseconds( 2 ), [&checks]( stop_check & stop ) -> expected<int, int>
+    {
+        while ( ! stop.stop_requested() )
+            ++checks;
+
+        return checks;
+    } );
+
+    EXPECT( r.error().is_timeout() );
+    EXPECT( ( checks + 1 ) % nsel_CONFIG_DEADLINE_CHECK_INTERVAL == 0 );
+}
+
+CASE( "call_with_deadline: Passes on the result of a nested call" )
+{
+    auto r = call_with_deadline( std::chrono::seconds( 10 ), []
+    {
+        return call_with_deadline( clock_type::now() - std::chrono::seconds( 1 ), answer );
+    } );
+
+    EXPECT( (std::is_same< decltype( r ), expected< int, cancelled_or_timeout<std::string> > >::value) );
+    EXPECT( r.error().is_timeout() );
+}
+
+CASE( "cancellable: Does not call the function once cancelled" )
+{
+    cancellation_source source;
+    int calls = 0;
+
+    source.request_stop();
+
+    auto r = cancellable( source.token(), [&calls]{ ++calls; return answer(); } );
+
+    EXPECT( calls == 0 );
+    EXPECT( r.error().is_cancelled() );
+    EXPECT( ( r.error() == cancelled_or_timeout<std::string>::cancelled() ) );
+}
+
+CASE( "cancellable: Yields cancelled if the function stops at a stop_check after cancellation" )
+{
+    cancellation_source source;
+
+    std::thread canceller( [&source]
+    {
+        std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+        source.request_stop();
+    } );
+
+    auto r = cancellable( source.token(), []( stop_check & stop ) -> expected<void, std::string>
+    {
+        while ( ! stop.stop_requested() )
+            std::this_thread::yield();
+
+        return {};
+    } );
+
+    canceller.join();
+
+    EXPECT( r.error().is_cancelled() );
+}
+
+CASE( "cancellable: Yields the result of a function that is not cancelled" )
+{
+    cancellation_source source;
+
+    auto r = cancellable( source.token(), answer );
+
+    EXPECT( r.value() == 42 );
+    EXPECT( ! source.stop_requested() );
+}
+
+// end of file
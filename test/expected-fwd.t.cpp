@@ -0,0 +1,116 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// the forward declarations first, as in an interface header:
+
+#include "nonstd/expected_fwd.hpp"
+
+#include <string>
+
+namespace fwd {
+
+struct widget;
+
+nonstd::expected<int, std::string> parse( char const * text );
+nonstd::expected<void, int> check( int value );
+nonstd::expected<widget, int> make_widget( int size );
+nonstd::unexpected_type<int> failure( int code );
+void accept( nonstd::unexpect_t );
+int code_of( nonstd::bad_expected_access<int> const & e );
+
+} // namespace fwd
+
+// then the definitions, as in the implementation:
+
+#include "expected-main.t.hpp"
+
+#include <type_traits>
+
+using namespace nonstd;
+
+namespace fwd {
+
+struct widget
+{
+    int size;
+};
+
+expected<int, std::string> parse( char const * text )
+{
+    if ( text[0] < '0' || text[0] > '9' )
+        return make_unexpected( std::string( text ) );
+
+    return text[0] - '0';
+}
+
+expected<void, int> check( int value )
+{
+    if ( value < 0 )
+        return make_unexpected( value );
+
+    return {};
+}
+
+expected<widget, int> make_widget( int size )
+{
+    return widget{ size };
+}
+
+unexpected_type<int> failure( int code )
+{
+    return unexpected_type<int>( code );
+}
+
+void accept( unexpect_t )
+{
+}
+
+#if !nsel_CONFIG_NO_EXCEPTIONS && !nsel_USES_STD_EXPECTED
+
+int code_of( bad_expected_access<int> const & e )
+{
+    return e.error();
+}
+
+#endif
+
+} // namespace fwd
+
+// -----------------------------------------------------------------------
+// expected_fwd.hpp
+
+CASE( "expected_fwd: Declares the types that expected.hpp defines" )
+{
+#if nsel_USES_STD_EXPECTED
+    EXPECT(( std::is_same< nonstd::expected<int, int>, std::expected<int, int> >::value ));
+#else
+    EXPECT(( std::is_same< nonstd::expected<int, int>, nonstd::expected_lite::expected<int, int> >::value ));
+    EXPECT(( std::is_same< nonstd::unexpected_type<int>, nonstd::expected_lite::unexpected_type<int> >::value ));
+    EXPECT(( std::is_same< nonstd::unexpect_t, nonstd::expected_lite::unexpect_t >::value ));
+#endif
+}
+
+CASE( "expected_fwd: Functions declared with incomplete expected types can be defined and called later" )
+{
+    EXPECT(  fwd::parse( "7" ).value() == 7 );
+    EXPECT(  fwd::parse( "x" ).error() == "x" );
+    EXPECT(  fwd::check( 1 ).has_value() );
+    EXPECT( !fwd::check( -1 ).has_value() );
+    EXPECT(  fwd::make_widget( 3 )->size == 3 );
+    EXPECT(  fwd::failure( 5 ).value() == 5 );
+}
+
+CASE( "expected_fwd: Declarations of expected.hpp and expected_fwd.hpp agree in either order" )
+{
+    // this file includes expected_fwd.hpp first, the others expected.hpp:
+
+    expected<int, std::string> e = fwd::parse( "4" );
+
+    EXPECT( e == 4 );
+}
+
+// end of file
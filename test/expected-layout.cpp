@@ -0,0 +1,184 @@
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+//
+// Layout report of common instantiations of expected<T,E>: size, alignment
+// and trivial copyability. With --baseline file, compare with the report in
+// that file and fail if a size or an alignment grew or if an instantiation
+// is no longer trivially copyable.
+//
+// Usage: expected-lite-layout [--baseline file]
+
+#include "nonstd/expected.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+using nonstd::expected;
+
+namespace {
+
+enum error_enum { failure_one = 1, failure_two };
+
+struct large_error
+{
+    char message[64];
+};
+
+struct empty {};
+
+struct layout
+{
+    std::size_t size;
+    std::size_t align;
+    bool        trivially_copyable;
+};
+
+using report = std::map<std::string, layout>;
+
+template< typename T, typename E >
+void add( report & r, std::string const & t, char const * e )
+{
+    using type = expected<T, E>;
+
+    r[ "expected<" + t + "," + e + ">" ] = layout{ sizeof( type ), alignof( type ), std::is_trivially_copyable<type>::value };
+}
+
+template< typename T >
+void add_row( report & r, std::string const & t )
+{
+    add< T, error_enum  >( r, t, "enum" );
+    add< T, std::errc   >( r, t, "std::errc" );
+    add< T, large_error >( r, t, "large_error" );
+}
+
+report current()
+{
+    report r;
+
+    add_row< int                >( r, "int" );
+    add_row< int *              >( r, "int*" );
+    add_row< std::string        >( r, "std::string" );
+    add_row< std::error_code    >( r, "std::error_code" );
+    add_row< std::exception_ptr >( r, "std::exception_ptr" );
+    add_row< void               >( r, "void" );
+    add_row< empty              >( r, "empty" );
+
+    return r;
+}
+
+// report as lines of: type size align trivially-copyable; # starts a comment.
+
+void print( report const & r )
+{
+    std::printf( "# expected-lite layout, __cplusplus %ld: type sizeof alignof trivially-copyable\n", static_cast<long>( __cplusplus ) );
+
+    for ( auto const & row : r )
+        std::printf( "%s %lu %lu %d\n", row.first.c_str()
+            , static_cast<unsigned long>( row.second.size ), static_cast<unsigned long>( row.second.align ), row.second.trivially_copyable ? 1 : 0 );
+}
+
+bool read( char const * path, report & r )
+{
+    std::ifstream in( path );
+    std::string line;
+
+    if ( ! in )
+        return false;
+
+    while ( std::getline( in, line ) )
+    {
+        std::istringstream is( line );
+        std::string name;
+        layout l = {};
+        int trivial = 0;
+
+        if ( line.empty() || line[0] == '#' )
+            continue;
+
+        if ( is >> name >> l.size >> l.align >> trivial )
+        {
+            l.trivially_copyable = trivial != 0;
+            r[ name ] = l;
+        }
+    }
+    return true;
+}
+
+// the number of instantiations whose layout regressed compared with baseline.
+
+int compare( report const & now, report const & baseline )
+{
+    int regressions = 0;
+
+    for ( auto const & row : now )
+    {
+        auto const pos = baseline.find( row.first );
+
+        if ( pos == baseline.end() )
+        {
+            std::printf( "layout: %s: not in baseline\n", row.first.c_str() );
+            continue;
+        }
+
+        layout const & was = pos->second;
+        layout const & is  = row.second;
+
+        if ( is.size > was.size )
+        {
+            std::printf( "layout: %s: sizeof grew from %lu to %lu\n", row.first.c_str()
+                , static_cast<unsigned long>( was.size ), static_cast<unsigned long>( is.size ) );
+            ++regressions;
+        }
+        if ( is.align > was.align )
+        {
+            std::printf( "layout: %s: alignof grew from %lu to %lu\n", row.first.c_str()
+                , static_cast<unsigned long>( was.align ), static_cast<unsigned long>( is.align ) );
+            ++regressions;
+        }
+        if ( was.trivially_copyable && ! is.trivially_copyable )
+        {
+            std::printf( "layout: %s: no longer trivially copyable\n", row.first.c_str() );
+            ++regressions;
+        }
+    }
+    return regressions;
+}
+
+} // anonymous namespace
+
+int main( int argc, char * argv[] )
+{
+    const report now = current();
+
+    print( now );
+
+    if ( argc == 3 && 0 == std::strcmp( argv[1], "--baseline" ) )
+    {
+        report baseline;
+
+        if ( ! read( argv[2], baseline ) )
+        {
+            std::printf( "layout: cannot read baseline '%s'\n", argv[2] );
+            return EXIT_FAILURE;
+        }
+
+        const int regressions = compare( now, baseline );
+
+        std::printf( "layout: %d regression%s compared with '%s'\n", regressions, regressions == 1 ? "" : "s", argv[2] );
+        return regressions == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+// end of file
@@ -0,0 +1,126 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_parallel.hpp"
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+using namespace nonstd;
+
+namespace {
+
+std::vector<int> iota_vector( int n )
+{
+    std::vector<int> v( static_cast<std::size_t>( n ) );
+    std::iota( v.begin(), v.end(), 0 );
+    return v;
+}
+
+// job that runs until cancelled.
+
+struct SpinJob
+{
+    std::atomic<bool> cancelled{ false };
+    std::atomic<int>  runs{ 0 };
+
+    void run()
+    {
+        ++runs;
+        while ( ! cancelled.load() )
+            std::this_thread::yield();
+    }
+
+    void cancel() noexcept
+    {
+        cancelled = true;
+    }
+};
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// parallel_transform_expected()
+
+CASE( "parallel_transform_expected: Allows to transform a range on several threads" )
+{
+    auto src = iota_vector( 10000 );
+    std::vector< expected<long, std::string> > out( src.size() );
+
+    auto r = parallel_transform_expected( src.begin(), src.end(), out.begin()
+        , []( int x ) -> expected<long, std::string> { return 2L * x; }
+        , parallel_options( parallel_mode::all, 4, 64 ) );
+
+    EXPECT( r.has_value() );
+    EXPECT( out[0].value() == 0 );
+    EXPECT( out[9999].value() == 19998 );
+}
+
+CASE( "parallel_transform_expected: Yields the error of the lowest-indexed failing element" )
+{
+    auto src = iota_vector( 10000 );
+    std::vector< expected<int, int> > out( src.size() );
+
+    auto r = parallel_transform_expected( src.begin(), src.end(), out.begin()
+        , []( int x ) -> expected<int, int> { if ( x % 1000 == 999 ) return make_unexpected( x ); return x; }
+        , parallel_options( parallel_mode::all, 4, 16 ) );
+
+    EXPECT( r.error() == 999 );
+    EXPECT( out[9999].error() == 9999 );
+}
+
+CASE( "parallel_transform_expected: Stops claiming chunks after the first error" )
+{
+    auto src = iota_vector( 100000 );
+    std::vector< expected<int, int> > out( src.size(), make_unexpected( -1 ) );
+    std::atomic<int> calls( 0 );
+
+    auto r = parallel_transform_expected( src.begin(), src.end(), out.begin()
+        , [&calls]( int x ) -> expected<int, int> { ++calls; if ( x == 100 ) return make_unexpected( x ); return x; }
+        , parallel_options( parallel_mode::first_error, 4, 10 ) );
+
+    EXPECT( r.error() == 100 );
+    EXPECT( calls.load() < 100000 );
+    EXPECT( out[99].value() == 99 );
+    EXPECT( out[99999].error() == -1 );
+}
+
+CASE( "parallel_transform_expected: Rethrows an exception thrown by the function" )
+{
+    auto src = iota_vector( 1000 );
+    std::vector< expected<int, int> > out( src.size() );
+
+    EXPECT_THROWS_AS( parallel_transform_expected( src.begin(), src.end(), out.begin()
+        , []( int x ) -> expected<int, int> { if ( x == 500 ) throw std::runtime_error( "bad" ); return x; }
+        , parallel_options( parallel_mode::all, 4, 8 ) ), std::runtime_error );
+}
+
+CASE( "parallel_transform_expected: Allows an empty range" )
+{
+    std::vector<int> src;
+    std::vector< expected<int, int> > out;
+
+    EXPECT( parallel_transform_expected( src.begin(), src.end(), out.begin()
+        , []( int x ) -> expected<int, int> { return x; } ).has_value() );
+}
+
+CASE( "parallel_transform_expected: Cancels and joins its workers on an early exit" )
+{
+    SpinJob job;
+    {
+        nonstd::expected_lite::detail::worker_threads<SpinJob> workers( job );
+        workers.start( 2 );
+    }
+    EXPECT( job.runs == 2 );
+    EXPECT( job.cancelled );
+}
+
+// end of file
@@ -0,0 +1,151 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_pool.hpp"
+
+// GCC may lose track of which member of an expected<int, std::string> that
+// is passed by value through several continuations is active, and warn about the other one:
+
+#if defined(__GNUC__) && !defined(__clang__)
+# pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace nonstd;
+
+// -----------------------------------------------------------------------
+// work_stealing_pool, async_expected(), expected_future::then()
+
+CASE( "work_stealing_pool: Starts the requested number of workers" )
+{
+    work_stealing_pool pool( 3 );
+
+    EXPECT( pool.size() == 3u );
+}
+
+CASE( "async_expected: Yields the expected returned by the function" )
+{
+    work_stealing_pool pool( 2 );
+
+    auto a = async_expected( pool, []{ return expected<int, std::string>( 42 ); } );
+    auto b = async_expected( pool, []{ return expected<int, std::string>( make_unexpected( "no" ) ); } );
+
+    EXPECT( a.get().value() == 42 );
+    EXPECT( b.get().error().compare( "no" ) == 0 );
+}
+
+CASE( "async_expected: Yields a value or void as expected with std::exception_ptr as error" )
+{
+    work_stealing_pool pool( 2 );
+    int called = 0;
+
+    auto a = async_expected( pool, []{ return std::string( "value" ); } );
+    auto b = async_expected( pool, [&called]{ ++called; } );
+
+    EXPECT( ( std::is_same< decltype( a ), expected_future<std::string, std::exception_ptr> >::value ) );
+    EXPECT( a.get().value().compare( "value" ) == 0 );
+    EXPECT( b.get().has_value() );
+    EXPECT( called == 1 );
+}
+
+CASE( "async_expected: Captures an exception thrown by the function as error" )
+{
+    work_stealing_pool pool( 1 );
+
+    auto f = async_expected( pool, []() -> int { throw std::runtime_error( "thrown" ); } );
+    auto r = f.get();
+
+    EXPECT( ! r.has_value() );
+    EXPECT_THROWS_AS( std::rethrow_exception( r.error() ), std::runtime_error );
+}
+
+CASE( "async_expected: Runs all tasks, also when several submit concurrently" )
+{
+    work_stealing_pool pool( 4 );
+    std::atomic<int> sum( 0 );
+    std::vector<std::thread> submitters;
+
+    for ( int s = 0; s < 3; ++s )
+    {
+        submitters.emplace_back( [&pool, &sum]
+        {
+            std::vector< expected_future<void, std::exception_ptr> > futures;
+
+            for ( int i = 1; i <= 100; ++i )
+                futures.push_back( async_expected( pool, [&sum, i]{ sum += i; } ) );
+
+            for ( auto & f : futures )
+                f.wait();
+        } );
+    }
+
+    for ( auto & s : submitters ) s.join();
+
+    EXPECT( sum.load() == 3 * 5050 );
+}
+
+CASE( "async_expected: Allows to use the default pool" )
+{
+    EXPECT( async_expected( []{ return 7; } ).get().value() == 7 );
+}
+
+CASE( "expected_future: Allows to chain continuations via then" )
+{
+    work_stealing_pool pool( 2 );
+
+    auto r = async_expected( pool, []{ return expected<int, std::string>( 20 ); } )
+        .then( []( expected<int, std::string> e ) { return e ? expected<int, std::string>( *e + 1 ) : e; } )
+        .then( []( expected<int, std::string> e ) { return expected<int, std::string>( e.value() * 2 ); } )
+        .get();
+
+    EXPECT( r.value() == 42 );
+}
+
+CASE( "expected_future: Passes an error along a chain of continuations" )
+{
+    work_stealing_pool pool( 2 );
+
+    auto r = async_expected( pool, []{ return expected<int, std::string>( make_unexpected( "early" ) ); } )
+        .then( []( expected<int, std::string> e ) { return e ? expected<int, std::string>( *e + 1 ) : e; } )
+        .get();
+
+    EXPECT( r.error().compare( "early" ) == 0 );
+}
+
+CASE( "expected_future: Runs a continuation on the worker that produced its input" )
+{
+    work_stealing_pool pool( 4 );
+
+    for ( int i = 0; i < 20; ++i )
+    {
+        std::thread::id producer;
+        std::atomic<bool> registered( false );
+
+        auto first = async_expected( pool, [&producer, &registered]
+        {
+            producer = std::this_thread::get_id();
+            while ( ! registered.load() )
+                std::this_thread::yield();
+            return 1;
+        } );
+
+        auto second = first.then( []( expected<int, std::exception_ptr> ) { return std::this_thread::get_id(); } );
+        registered.store( true );
+
+        auto id = second.get().value();
+
+        EXPECT( id == producer );
+    }
+}
+
+// end of file
@@ -0,0 +1,216 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_queue.hpp"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace nonstd;
+
+namespace {
+
+// a value whose construction from an int throws for negative ints; its
+// default construction, for the value slot of an error, throws on request.
+
+struct Fragile
+{
+    static bool fail_default;
+
+    int x;
+
+    Fragile() : x( 0 ) { if ( fail_default ) throw std::runtime_error( "default" ); }
+    Fragile( int v ) : x( v ) { if ( v < 0 ) throw std::runtime_error( "negative" ); }
+    Fragile( Fragile && other ) noexcept : x( other.x ) {}
+    Fragile & operator=( Fragile && other ) noexcept { x = other.x; return *this; }
+};
+
+bool Fragile::fail_default = false;
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// expected_queue
+
+CASE( "expected_queue: Rounds its capacity up to a power of two" )
+{
+    expected_queue<int, int> q( 5 );
+
+    EXPECT( q.capacity() == 8u );
+}
+
+CASE( "expected_queue: Allows to push and pop values and errors in order" )
+{
+    expected_queue<std::string, int> q( 4 );
+
+    EXPECT( q.try_emplace( std::size_t( 3 ), 'a' ) );
+    EXPECT( q.try_emplace_error( 7 ) );
+    EXPECT( q.try_push( expected<std::string, int>( "b" ) ) );
+
+    expected<std::string, int> e;
+
+    EXPECT( q.try_pop( e ) ); EXPECT( e.value().compare( "aaa" ) == 0 );
+    EXPECT( q.try_pop( e ) ); EXPECT( e.error() == 7 );
+    EXPECT( q.try_pop( e ) ); EXPECT( e.value().compare( "b" ) == 0 );
+    EXPECT( ! q.try_pop( e ) );
+}
+
+CASE( "expected_queue: Refuses an element when full" )
+{
+    expected_queue<int, int> q( 2 );
+
+    EXPECT(   q.try_emplace( 1 ) );
+    EXPECT(   q.try_emplace( 2 ) );
+    EXPECT( ! q.try_emplace( 3 ) );
+    EXPECT( q.size_approx() == 2u );
+}
+
+CASE( "expected_queue: Counts the elements and errors enqueued" )
+{
+    expected_queue<int, int> q( 8 );
+
+    q.emplace( 1 );
+    q.emplace_error( 2 );
+    q.emplace_error( 3 );
+
+    EXPECT( q.enqueued_count() == 3u );
+    EXPECT( q.error_count() == 2u );
+}
+
+CASE( "expected_queue: Allows to pop a batch into an expected_vector" )
+{
+    expected_queue<int, std::string> q( 8 );
+    expected_vector<int, std::string> v;
+
+    for ( int i = 0; i < 6; ++i )
+    {
+        if ( i == 2 ) q.emplace_error( "two" );
+        else          q.emplace( i );
+    }
+
+    EXPECT( q.try_pop_n( v, 4 ) == 4u );
+    EXPECT( q.try_pop_n( v, 4 ) == 2u );
+    EXPECT( q.try_pop_n( v, 4 ) == 0u );
+
+    EXPECT( v.size() == 6u );
+    EXPECT( v.error_count() == 1u );
+    EXPECT( v.get( 2 ).error().compare( "two" ) == 0 );
+    EXPECT( v.get( 5 ).value() == 5 );
+}
+
+CASE( "expected_queue: Destroys the elements it still holds" )
+{
+    auto p = std::make_shared<int>( 1 );
+    {
+        expected_queue<std::shared_ptr<int>, int> q( 4 );
+        q.emplace( p );
+        q.emplace( p );
+        EXPECT( p.use_count() == 3 );
+    }
+    EXPECT( p.use_count() == 1 );
+}
+
+CASE( "expected_queue: Passes every element exactly once between several producers and consumers" )
+{
+    const int producers = 3;
+    const int per_producer = 2000;
+
+    expected_queue<int, int> q( 64 );
+    std::vector<std::thread> threads;
+    std::vector<long> sums( 3, 0 );
+    std::vector<int> errors( 3, 0 );
+
+    for ( int p = 0; p < producers; ++p )
+    {
+        threads.emplace_back( [&q, p]
+        {
+            for ( int i = 1; i <= per_producer; ++i )
+            {
+                if ( i % 10 == 0 ) q.emplace_error( i );
+                else               q.emplace( i );
+            }
+        } );
+    }
+
+    for ( int c = 0; c < 3; ++c )
+    {
+        threads.emplace_back( [&q, &sums, &errors, c]
+        {
+            expected_vector<int, int> batch;
+            int seen = 0;
+
+            while ( seen < producers * per_producer / 3 )
+            {
+                const std::size_t n = q.try_pop_n( batch, static_cast<std::size_t>( producers * per_producer / 3 - seen ) );
+
+                if ( n == 0 ) std::this_thread::yield();
+                seen += static_cast<int>( n );
+            }
+
+            for ( std::size_t i = 0; i != batch.size(); ++i )
+            {
+                if ( batch.has_value( i ) ) sums[ static_cast<std::size_t>( c ) ] += *batch.get( i );
+                else                        ++errors[ static_cast<std::size_t>( c ) ];
+            }
+        } );
+    }
+
+    for ( auto & t : threads ) t.join();
+
+    const long total = sums[0] + sums[1] + sums[2];
+    const long expect = producers * ( long( per_producer ) * ( per_producer + 1 ) / 2 - 10L * ( 200 * 201 / 2 ) );
+
+    EXPECT( total == expect );
+    EXPECT( errors[0] + errors[1] + errors[2] == producers * per_producer / 10 );
+    EXPECT( q.error_count() == std::uint64_t( producers * per_producer / 10 ) );
+}
+
+CASE( "expected_queue: Remains usable after the construction of an element throws" )
+{
+    expected_queue<Fragile, int> q( 2 );
+
+    EXPECT_THROWS_AS( q.try_emplace( -1 ), std::runtime_error );
+    EXPECT_THROWS_AS( q.try_emplace( -2 ), std::runtime_error );
+
+    EXPECT( q.try_emplace( 1 ) );
+    EXPECT( q.try_emplace( 2 ) );
+    EXPECT( q.size_approx() == 2u );
+
+    expected<Fragile, int> e;
+
+    EXPECT( q.try_pop( e ) ); EXPECT( e.value().x == 1 );
+    EXPECT( q.try_pop( e ) ); EXPECT( e.value().x == 2 );
+}
+
+CASE( "expected_queue: Drops the rest of a batch and remains usable if appending to the expected_vector throws" )
+{
+    expected_queue<Fragile, int> q( 4 );
+    expected_vector<Fragile, int> v;
+
+    q.emplace( 1 );
+    q.emplace_error( 2 );
+    q.emplace( 3 );
+
+    Fragile::fail_default = true;
+    EXPECT_THROWS_AS( q.try_pop_n( v, 4 ), std::runtime_error );
+    Fragile::fail_default = false;
+
+    EXPECT( v.size() == 1u );
+    EXPECT( q.size_approx() == 0u );
+
+    for ( int i = 0; i < 4; ++i )
+        EXPECT( q.try_emplace( i ) );
+
+    EXPECT( q.try_pop_n( v, 4 ) == 4u );
+    EXPECT( v.size() == 5u );
+}
+
+// end of file
@@ -0,0 +1,241 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_sender.hpp"
+
+// GCC may lose track of which member of an expected<int, std::string> that
+// is moved through several senders is active, and warn about the other one:
+
+#if defined(__GNUC__) && !defined(__clang__)
+# pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+
+using namespace nonstd;
+
+namespace {
+
+template< typename... Ts >
+struct List {};
+
+// receiver that records how it was completed.
+
+struct Recorder
+{
+    std::string * log;
+
+    void set_value( int v ) noexcept              { *log += "value " + std::to_string( v ); }
+    void set_value() noexcept                     { *log += "value"; }
+    void set_error( std::string const & e ) noexcept { *log += "error " + e; }
+    void set_stopped() noexcept                   { *log += "stopped"; }
+};
+
+// sender of a local implementation that completes on a thread of its own.
+
+struct ThreadSender
+{
+    template< template< typename... > class Tuple, template< typename... > class Variant >
+    using value_types = Variant< Tuple<int> >;
+
+    template< template< typename... > class Variant >
+    using error_types = Variant<std::string>;
+
+    static constexpr bool sends_stopped = false;
+
+    int value;
+
+    template< typename R >
+    struct operation
+    {
+        int value;
+        R   receiver;
+
+        void start() noexcept
+        {
+            std::thread( [this]{ std::move( receiver ).set_value( value ); } ).detach();
+        }
+    };
+
+    template< typename R >
+    operation<R> connect( R r ) &&
+    {
+        return operation<R>{ value, std::move( r ) };
+    }
+};
+
+// sender that completes with set_stopped().
+
+struct StoppedSender
+{
+    template< template< typename... > class Tuple, template< typename... > class Variant >
+    using value_types = Variant< Tuple<int> >;
+
+    template< template< typename... > class Variant >
+    using error_types = Variant<int>;
+
+    static constexpr bool sends_stopped = true;
+
+    template< typename R >
+    struct operation
+    {
+        R receiver;
+
+        void start() noexcept
+        {
+            std::move( receiver ).set_stopped();
+        }
+    };
+
+    template< typename R >
+    operation<R> connect( R r ) &&
+    {
+        return operation<R>{ std::move( r ) };
+    }
+};
+
+struct Failure
+{
+    bool stopped = false;
+
+    Failure() = default;
+    Failure( std::string const & ) {}
+    Failure( sender_stopped ) : stopped( true ) {}
+};
+
+struct Throws
+{
+    Throws( int ) { throw std::runtime_error( "construction" ); }
+};
+
+expected<int, std::string> half( int x )
+{
+    if ( x % 2 )
+        return make_unexpected( std::string( "odd" ) );
+
+    return x / 2;
+}
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// as_sender(), expected_receiver, sync_wait_expected(), transform_expected()
+
+CASE( "as_sender: Completes with set_value for a value and with set_error for an error" )
+{
+    std::string log;
+
+    auto op1 = as_sender( expected<int, std::string>( 3 ) ).connect( Recorder{ &log } );
+    op1.start();
+    log += ", ";
+
+    auto op2 = as_sender( expected<int, std::string>( make_unexpected( std::string( "bad" ) ) ) ).connect( Recorder{ &log } );
+    op2.start();
+    log += ", ";
+
+    auto op3 = as_sender( expected<void, std::string>() ).connect( Recorder{ &log } );
+    op3.start();
+
+    EXPECT( log.compare( "value 3, error bad, value" ) == 0 );
+}
+
+CASE( "as_sender: Describes its completions via value_types and error_types" )
+{
+    using sender = expected_sender<int, std::string>;
+
+    EXPECT( (std::is_same< sender::value_types< std::tuple, List >, List< std::tuple<int> > >::value) );
+    EXPECT( (std::is_same< sender::error_types< List >, List< std::string > >::value) );
+    EXPECT( (std::is_same< expected_sender<void, int>::value_types< std::tuple, List >, List< std::tuple<> > >::value) );
+}
+
+CASE( "expected_receiver: Turns an exception from constructing the value into an exception_ptr error" )
+{
+    expected_slot<Throws, std::exception_ptr> slot;
+
+    expected_receiver<Throws, std::exception_ptr>( slot ).set_value( 7 );
+
+    EXPECT( slot.is_ready() );
+    EXPECT_THROWS_AS( std::rethrow_exception( slot.get().error() ), std::runtime_error );
+}
+
+CASE( "expected_receiver: Is noexcept only if constructing the value or error cannot throw or is captured" )
+{
+    EXPECT(  noexcept( std::declval< expected_receiver<int, std::string> >().set_value( 7 ) ) );
+    EXPECT(  noexcept( std::declval< expected_receiver<Throws, std::exception_ptr> >().set_value( 7 ) ) );
+    EXPECT( !noexcept( std::declval< expected_receiver<Throws, std::string> >().set_value( 7 ) ) );
+    EXPECT( !noexcept( std::declval< expected_receiver<int, std::string> >().set_error( "bad" ) ) );
+}
+
+CASE( "sync_wait_expected: Collects the value or error of a sender into an expected" )
+{
+    EXPECT( sync_wait_expected( as_sender( expected<int, std::string>( 5 ) ) ).value() == 5 );
+    EXPECT( sync_wait_expected( as_sender( expected<int, std::string>( make_unexpected( std::string( "bad" ) ) ) ) ).error().compare( "bad" ) == 0 );
+    EXPECT( sync_wait_expected( as_sender( expected<void, int>() ) ).has_value() );
+}
+
+CASE( "sync_wait_expected: Waits for a sender that completes on another thread" )
+{
+    auto e = sync_wait_expected( ThreadSender{ 42 } );
+
+    EXPECT( (std::is_same< decltype( e ), expected<int, std::string> >::value) );
+    EXPECT( e.value() == 42 );
+}
+
+CASE( "sync_wait_expected: Turns set_stopped into an error if the error type accepts sender_stopped" )
+{
+    auto e = sync_wait_expected<int, Failure>( StoppedSender{} );
+
+    EXPECT( ! e.has_value() );
+    EXPECT( e.error().stopped );
+}
+
+CASE( "transform_expected: Passes the value of a sender to an expected-returning function" )
+{
+    EXPECT( sync_wait_expected( transform_expected( as_sender( expected<int, std::string>( 8 ) ), half ) ).value() == 4 );
+    EXPECT( sync_wait_expected( transform_expected( ThreadSender{ 6 }, half ) ).value() == 3 );
+    EXPECT( sync_wait_expected( transform_expected( as_sender( expected<int, std::string>( 7 ) ), half ) ).error().compare( "odd" ) == 0 );
+}
+
+CASE( "transform_expected: Passes an error of the sender through" )
+{
+    auto s = transform_expected( transform_expected( as_sender( expected<int, std::string>( make_unexpected( std::string( "bad" ) ) ) ), half ), half );
+
+    EXPECT( (sync_wait_expected<int, std::string>( std::move( s ) ).error() == "bad") );
+}
+
+CASE( "transform_expected: Is noexcept only if the function and the receiver's completions are" )
+{
+    auto f = []( int x ) noexcept { return expected<int, std::string>( x ); };
+
+    using nothrow_receiver  = expected_transform_receiver< decltype( f ), Recorder >;
+    using throwing_function = expected_transform_receiver< decltype( &half ), Recorder >;
+    using throwing_receiver = expected_transform_receiver< decltype( f ), expected_receiver<Throws, std::string> >;
+
+    EXPECT(  noexcept( std::declval< nothrow_receiver  >().set_value( 1 ) ) );
+    EXPECT( !noexcept( std::declval< throwing_function >().set_value( 1 ) ) );
+    EXPECT( !noexcept( std::declval< throwing_receiver >().set_value( 1 ) ) );
+    EXPECT(  noexcept( std::declval< expected_operation<int, std::string, Recorder> >().start() ) );
+    EXPECT( !noexcept( std::declval< expected_operation<int, std::string, expected_receiver<Throws, std::string> > >().start() ) );
+}
+
+CASE( "transform_expected: Propagates an exception of the function to the caller of start()" )
+{
+    std::string log;
+
+    auto s  = transform_expected( as_sender( expected<int, std::string>( 1 ) ), []( int ) -> expected<int, std::string> { throw std::runtime_error( "f" ); } );
+    auto op = std::move( s ).connect( Recorder{ &log } );
+
+    EXPECT_THROWS_AS( op.start(), std::runtime_error );
+    EXPECT( log.empty() );
+}
+
+// end of file
@@ -0,0 +1,244 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_simd.hpp"
+
+#include <string>
+
+using namespace nonstd;
+
+namespace {
+
+// error at every index that is a multiple of 3 or 64, or lies in [200,264):
+
+bool is_error( std::size_t i )
+{
+    return i % 3 == 0 || i % 64 == 0 || ( i >= 200 && i < 264 );
+}
+
+template< typename T >
+expected_vector<T, int> make_pattern( std::size_t n )
+{
+    expected_vector<T, int> v;
+
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        if ( is_error( i ) ) v.emplace_error( static_cast<int>( i ) );
+        else                 v.push_back( static_cast<T>( i ) );
+    }
+    return v;
+}
+
+template< typename T >
+std::vector<T> expected_values( std::size_t n )
+{
+    std::vector<T> r;
+
+    for ( std::size_t i = 0; i < n; ++i )
+    {
+        if ( ! is_error( i ) ) r.push_back( static_cast<T>( i ) );
+    }
+    return r;
+}
+
+bool have_level( simd_level level )
+{
+    return static_cast<int>( current_simd_level() ) >= static_cast<int>( level );
+}
+
+const std::size_t sizes[] = { 0, 1, 5, 63, 64, 65, 130, 255, 256, 257, 300, 1000, 1027 };
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// batch kernels
+
+CASE( "expected_simd: Allows to count the errors of a validity bitmap" )
+{
+    for ( auto n : sizes )
+    {
+        auto v = make_pattern<int>( n );
+        auto errors = n - expected_values<int>( n ).size();
+
+        EXPECT( count_errors( v ) == errors );
+        EXPECT( simd::scalar::count_errors( v.validity_data(), n ) == errors );
+#if nsel_HAVE_X86_SIMD
+        if ( have_level( simd_level::sse42 ) ) EXPECT( simd::sse42::count_errors( v.validity_data(), n ) == errors );
+        if ( have_level( simd_level::avx2  ) ) EXPECT( simd::avx2 ::count_errors( v.validity_data(), n ) == errors );
+#endif
+    }
+}
+
+CASE( "expected_simd: Allows to find the first error of a validity bitmap" )
+{
+    for ( auto n : sizes )
+    {
+        std::vector<int> ones( n, 1 );
+        expected_vector<int, int> v;
+
+        v.append_values( ones.begin(), ones.end() );
+
+        EXPECT( first_error( v ) == n );
+
+        v.emplace_error( 7 );
+        v.push_back( 3 );
+        v.emplace_error( 8 );
+
+        EXPECT( first_error( v ) == n );
+        EXPECT( simd::scalar::first_error( v.validity_data(), v.size() ) == n );
+#if nsel_HAVE_X86_SIMD
+        if ( have_level( simd_level::sse42 ) ) EXPECT( simd::sse42::first_error( v.validity_data(), v.size() ) == n );
+        if ( have_level( simd_level::avx2  ) ) EXPECT( simd::avx2 ::first_error( v.validity_data(), v.size() ) == n );
+#endif
+    }
+}
+
+CASE( "expected_simd: Allows to compact the values of 4- and 8-byte elements" )
+{
+    SETUP("") {
+    SECTION("int") {
+        for ( auto n : sizes )
+        {
+            auto v = make_pattern<int>( n );
+            auto x = expected_values<int>( n );
+
+            std::vector<int> out( n );
+            EXPECT( compact_values( v, out.data() ) == x.size() );
+            EXPECT( std::vector<int>( out.begin(), out.begin() + static_cast<long>( x.size() ) ) == x );
+        }
+    }
+    SECTION("long long") {
+        for ( auto n : sizes )
+        {
+            auto v = make_pattern<long long>( n );
+            auto x = expected_values<long long>( n );
+
+            std::vector<long long> out( n );
+            EXPECT( compact_values( v, out.data() ) == x.size() );
+            EXPECT( std::vector<long long>( out.begin(), out.begin() + static_cast<long>( x.size() ) ) == x );
+        }
+    }
+    SECTION("double") {
+        for ( auto n : sizes )
+        {
+            auto v = make_pattern<double>( n );
+            auto x = expected_values<double>( n );
+
+            std::vector<double> out( n );
+            EXPECT( compact_values( v, out.data() ) == x.size() );
+            EXPECT( std::vector<double>( out.begin(), out.begin() + static_cast<long>( x.size() ) ) == x );
+        }
+    }}
+}
+
+CASE( "expected_simd: Allows to compact the values of other elements" )
+{
+    expected_vector<std::string, int> v;
+
+    for ( int i = 0; i < 100; ++i )
+    {
+        if ( i % 4 == 0 ) v.emplace_error( i );
+        else              v.push_back( std::to_string( i ) );
+    }
+
+    std::vector<std::string> out( v.size() );
+
+    EXPECT( compact_values( v, out.data() ) == 75u );
+    EXPECT( out[0]  == "1" );
+    EXPECT( out[3]  == "5" );
+    EXPECT( out[74] == "99" );
+}
+
+CASE( "expected_simd: Allows to replace the value slot of errors" )
+{
+    for ( auto n : sizes )
+    {
+        auto v = make_pattern<int>( n );
+        auto w = make_pattern<double>( n );
+
+        value_or_fill( v, -1 );
+        value_or_fill( w, 0.5 );
+
+        bool ok = true;
+        for ( std::size_t i = 0; i < n; ++i )
+        {
+            ok = ok && v.value_data()[i] == ( is_error( i ) ? -1  : static_cast<int>( i ) );
+            ok = ok && w.value_data()[i] == ( is_error( i ) ? 0.5 : static_cast<double>( i ) );
+        }
+        EXPECT( ok );
+        EXPECT( v.error_count() == count_errors( v ) );
+    }
+}
+
+CASE( "expected_simd: Gives the same results for each instruction set" )
+{
+    const std::size_t n = 1027;
+
+    auto v = make_pattern<long long>( n );
+
+    std::vector<long long> out0( n ), out1( n ), out2( n );
+    auto m0 = simd::scalar::compact_values( v.validity_data(), v.value_data(), n, out0.data() );
+    auto m1 = m0;
+    auto m2 = m0;
+
+#if nsel_HAVE_X86_SIMD
+    if ( have_level( simd_level::avx2 ) )
+    {
+        m1 = simd::avx2::compact_values( v.validity_data(), v.value_data(), n, out1.data() );
+    }
+    else
+#endif
+    {
+        out1 = out0;
+    }
+
+#if nsel_HAVE_X86_SIMD
+    if ( have_level( simd_level::sse42 ) )
+    {
+        m2 = simd::sse42::compact_values( v.validity_data(), v.value_data(), n, out2.data() );
+    }
+    else
+#endif
+    {
+        out2 = out0;
+    }
+
+    EXPECT( m0 == m1 );
+    EXPECT( m0 == m2 );
+    EXPECT( out0 == out1 );
+    EXPECT( out0 == out2 );
+
+    auto a = make_pattern<int>( n );
+    auto b = a;
+
+    std::vector<int> ints0( n ), ints1( n );
+    auto k0 = simd::scalar::compact_values( a.validity_data(), a.value_data(), n, ints0.data() );
+    auto k1 = k0;
+
+#if nsel_HAVE_X86_SIMD
+    if ( have_level( simd_level::sse42 ) )
+        k1 = simd::sse42::compact_values( a.validity_data(), a.value_data(), n, ints1.data() );
+    else
+#endif
+        ints1 = ints0;
+
+    EXPECT( k0 == k1 );
+    EXPECT( ints0 == ints1 );
+
+    simd::scalar::value_or_fill( a.validity_data(), a.value_data(), n, 42 );
+#if nsel_HAVE_X86_SIMD
+    if ( have_level( simd_level::sse42 ) )
+        simd::sse42::value_or_fill( b.validity_data(), b.value_data(), n, 42 );
+    else
+#endif
+        simd::scalar::value_or_fill( b.validity_data(), b.value_data(), n, 42 );
+
+    EXPECT( std::equal( a.value_data(), a.value_data() + n, b.value_data() ) );
+}
+
+// end of file
@@ -0,0 +1,163 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_slot.hpp"
+
+#include <memory>
+#include <string>
+#include <thread>
+
+using namespace nonstd;
+
+namespace {
+
+struct Record
+{
+    std::thread::id thread;
+    int             value = 0;
+    int             calls = 0;
+
+    void operator()( expected_slot<int, std::string> & slot )
+    {
+        thread = std::this_thread::get_id();
+        value  = slot.get().value();
+        ++calls;
+    }
+};
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// expected_slot, expected_promise, expected_future
+
+CASE( "expected_slot: Allows to hand a value from one thread to another" )
+{
+    expected_slot<int, std::string> slot;
+
+    std::thread producer( [&slot]{ slot.set_value( 42 ); } );
+
+    auto r = slot.get();
+    producer.join();
+
+    EXPECT( r.value() == 42 );
+}
+
+CASE( "expected_slot: Allows to hand an error from one thread to another" )
+{
+    expected_slot<int, std::string> slot;
+
+    std::thread producer( [&slot]{ slot.set_error( "failed" ); } );
+
+    slot.wait();
+    producer.join();
+
+    EXPECT( slot.is_ready() );
+    EXPECT( slot.get().error().compare( "failed" ) == 0 );
+}
+
+CASE( "expected_slot: Allows to hand over an expected<void,E> and move-only values" )
+{
+    expected_slot<void, int> v;
+    expected_slot<std::unique_ptr<int>, int> p;
+
+    v.set_result( expected<void, int>() );
+    p.set_value( new int( 7 ) );
+
+    EXPECT( v.get().has_value() );
+    EXPECT( *p.get().value() == 7 );
+}
+
+CASE( "expected_slot: Allows the consumer to destroy the slot once it has the result" )
+{
+    for ( int i = 0; i != 200; ++i )
+    {
+        std::unique_ptr< expected_slot<int, std::string> > slot( new expected_slot<int, std::string>() );
+        expected_slot<int, std::string> * p = slot.get();
+
+        std::thread producer( [p, i]{ p->set_value( i ); } );
+
+        auto r = slot->get();
+        slot.reset();
+        producer.join();
+
+        EXPECT( r.value() == i );
+    }
+}
+
+CASE( "expected_slot: Times out waiting for a result that does not arrive" )
+{
+    expected_slot<int, int> slot;
+
+    EXPECT( ! slot.wait_for( std::chrono::milliseconds( 1 ) ) );
+
+    slot.set_error( 3 );
+
+    EXPECT( slot.wait_for( std::chrono::milliseconds( 1 ) ) );
+}
+
+CASE( "expected_slot: Runs a continuation registered before the result on the producer thread" )
+{
+    expected_slot<int, std::string> slot;
+    Record record;
+
+    slot.on_ready( record );
+
+    std::thread producer( [&slot]{ slot.set_value( 5 ); } );
+    const std::thread::id producer_id = producer.get_id();
+    producer.join();
+
+    EXPECT( record.calls == 1 );
+    EXPECT( record.value == 5 );
+    EXPECT( record.thread == producer_id );
+}
+
+CASE( "expected_slot: Runs a continuation registered after the result inline" )
+{
+    expected_slot<int, std::string> slot;
+    Record record;
+
+    slot.set_value( 6 );
+    slot.on_ready( record );
+
+    EXPECT( record.calls == 1 );
+    EXPECT( record.value == 6 );
+    EXPECT( record.thread == std::this_thread::get_id() );
+}
+
+CASE( "expected_slot: Allows to be reset for another handoff" )
+{
+    expected_slot<std::string, int> slot;
+
+    for ( int i = 0; i < 100; ++i )
+    {
+        std::thread producer( [&slot, i]{ slot.set_value( std::to_string( i ) ); } );
+
+        EXPECT( slot.get().value().compare( std::to_string( i ) ) == 0 );
+
+        producer.join();
+        slot.reset();
+        EXPECT( ! slot.is_ready() );
+    }
+}
+
+CASE( "expected_promise: Allows to hand a result to an expected_future" )
+{
+    expected_slot<int, std::string> slot;
+    expected_future <int, std::string> future  = slot.get_future();
+    expected_promise<int, std::string> promise = slot.get_promise();
+
+    std::thread producer( [promise]() mutable { promise.set_result( expected<int, std::string>( 9 ) ); } );
+
+    future.wait();
+    producer.join();
+
+    EXPECT( future.is_ready() );
+    EXPECT( future.get().value() == 9 );
+}
+
+// end of file
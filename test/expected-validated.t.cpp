@@ -0,0 +1,180 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_validated.hpp"
+
+#include <string>
+
+using namespace nonstd;
+
+namespace {
+
+using field = validated<int, std::string, 2>;
+using field_errors = error_list<std::string, 2>;
+
+field positive( int x )
+{
+    if ( x > 0 ) return x;
+    return make_unexpected( "not positive: " + std::to_string( x ) );
+}
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// error_list<>
+
+CASE( "error_list: Keeps up to N errors inline" )
+{
+    error_list<std::string, 2> list;
+
+    list.push_back( "a" );
+    list.emplace_back( 1u, 'b' );
+
+    EXPECT( list.size() == 2u );
+    EXPECT( list.is_inline() );
+    EXPECT( list[1] == "b" );
+}
+
+CASE( "error_list: Moves its errors to the heap beyond N errors" )
+{
+    error_list<std::string, 2> list = { "a", "b" };
+
+    list.push_back( "c" );
+
+    EXPECT( ! list.is_inline() );
+    EXPECT( list.size() == 3u );
+    EXPECT( list.front() == "a" );
+    EXPECT( list.back()  == "c" );
+}
+
+CASE( "error_list: Allows to append one of its own errors when that makes it grow" )
+{
+    const std::string text = "an error too long for the small string buffer";
+
+    error_list<std::string, 2> list = { text, "b" };
+
+    list.push_back( list[0] );
+    list.push_back( list.back() );
+    list.emplace_back( list.front() );
+
+    EXPECT( list.size() == 5u );
+    EXPECT( list[2] == text );
+    EXPECT( list[3] == text );
+    EXPECT( list[4] == text );
+}
+
+CASE( "error_list: Allows to be copied and moved, inline and on the heap" )
+{
+    error_list<std::string, 2> small = { "a" };
+    error_list<std::string, 2> large = { "a", "b", "c" };
+
+    auto small2 = small;
+    auto large2 = large;
+
+    EXPECT( small2 == small );
+    EXPECT( large2 == large );
+
+    auto small3 = std::move( small2 );
+    auto large3 = std::move( large2 );
+
+    EXPECT( small3 == small );
+    EXPECT( large3 == large );
+    EXPECT( small2.empty() );
+    EXPECT( large2.empty() );
+
+    small3 = large3;
+
+    EXPECT( small3 == large );
+}
+
+// -----------------------------------------------------------------------
+// validated<>
+
+CASE( "validated: Allows to construct from a value or an error" )
+{
+    field v = 3;
+    field e = make_unexpected( std::string( "bad" ) );
+
+    EXPECT( v.has_value() );
+    EXPECT( *v == 3 );
+    EXPECT( ! e );
+    EXPECT( e.errors().size() == 1u );
+    EXPECT( e.errors()[0] == "bad" );
+}
+
+CASE( "validated: Allows to construct from and convert to expected" )
+{
+    expected<int, std::string> x = 7;
+    expected<int, std::string> y = make_unexpected( std::string( "bad" ) );
+
+    field v = x;
+    field e = y;
+
+    EXPECT( v.value() == 7 );
+    EXPECT( e.errors()[0] == "bad" );
+
+    EXPECT( v.to_expected() == x );
+    EXPECT( e.to_expected().error() == "bad" );
+    EXPECT( e.to_expected_all().error().size() == 1u );
+}
+
+CASE( "validated: Throws bad_expected_access with the error list on value access of an error" )
+{
+    field e = make_unexpected( std::string( "bad" ) );
+
+    EXPECT_THROWS_AS( e.value(), bad_expected_access<field_errors> );
+}
+
+CASE( "validated: Allows to be copied, moved and swapped" )
+{
+    field v = 1;
+    field e = make_unexpected( std::string( "bad" ) );
+
+    field a = v;
+    field b = std::move( field( e ) );
+
+    swap( a, b );
+
+    EXPECT( ! a );
+    EXPECT( *b == 1 );
+
+    a = v;
+
+    EXPECT( *a == 1 );
+}
+
+CASE( "combine: Allows to combine the values of several validated into a tuple" )
+{
+    auto r = combine( positive( 1 ), positive( 2 ), validated<std::string, std::string, 2>( std::string( "x" ) ) );
+
+    EXPECT( r.has_value() );
+    EXPECT( std::get<0>( *r ) == 1 );
+    EXPECT( std::get<2>( *r ) == "x" );
+}
+
+CASE( "combine: Collects the errors of all arguments in argument order" )
+{
+    auto r = combine( positive( -1 ), positive( 2 ), positive( -3 ), positive( 0 ) );
+
+    EXPECT( ! r );
+    EXPECT( r.errors().size() == 3u );
+    EXPECT( r.errors()[0] == "not positive: -1" );
+    EXPECT( r.errors()[1] == "not positive: -3" );
+    EXPECT( r.errors()[2] == "not positive: 0"  );
+}
+
+CASE( "combine_with: Allows to apply a function to the values of several validated" )
+{
+    auto r = combine_with( []( int x, int y ) { return x + y; }, positive( 1 ), positive( 2 ) );
+    auto e = combine_with( []( int x, int y ) { return x + y; }, positive( -1 ), positive( -2 ) );
+
+    EXPECT( *r == 3 );
+    EXPECT( e.errors().size() == 2u );
+}
+
+// end of file
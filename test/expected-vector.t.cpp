@@ -0,0 +1,250 @@
+// This version targets C++11 and later.
+//
+// Copyright (c) 2016-2020 Martin Moene.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include "expected-main.t.hpp"
+#include "nonstd/expected_vector.hpp"
+
+// GCC may lose track of which member of an expected<int, std::string> that
+// is moved into a std::vector is active, and warn about the other one:
+
+#if defined(__GNUC__) && !defined(__clang__)
+# pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <stdexcept>
+#include <string>
+
+using namespace nonstd;
+
+namespace {
+
+expected_vector<int, std::string> make_mixed( int n )
+{
+    expected_vector<int, std::string> v;
+
+    for ( int i = 0; i < n; ++i )
+    {
+        if ( i % 3 == 0 ) v.emplace_error( "error " + std::to_string( i ) );
+        else              v.push_back( i );
+    }
+    return v;
+}
+
+// value that throws on construction while Fragile::fail is set.
+
+struct Fragile
+{
+    static bool fail;
+
+    int v;
+
+    Fragile( int x = 0 ) : v( x ) { if ( fail ) throw std::runtime_error( "fragile" ); }
+};
+
+bool Fragile::fail = false;
+
+} // anonymous namespace
+
+// -----------------------------------------------------------------------
+// expected_vector<>
+
+CASE( "expected_vector: Allows to default construct" )
+{
+    expected_vector<int, std::string> v;
+
+    EXPECT( v.empty() );
+    EXPECT( v.size() == 0u );
+    EXPECT( v.error_count() == 0u );
+}
+
+CASE( "expected_vector: Allows to push_back values and errors" )
+{
+    expected_vector<int, std::string> v;
+
+    v.push_back( 7 );
+    v.push_back( make_unexpected( std::string( "bad" ) ) );
+    v.push_back( expected<int, std::string>( 9 ) );
+    v.push_back( expected<int, std::string>( unexpect, "worse" ) );
+
+    EXPECT( v.size() == 4u );
+    EXPECT( v.value_count() == 2u );
+    EXPECT( v.error_count() == 2u );
+
+    EXPECT(   v.has_value( 0 ) );
+    EXPECT( ! v.has_value( 1 ) );
+    EXPECT(   v.has_value( 2 ) );
+    EXPECT( ! v.has_value( 3 ) );
+
+    EXPECT( v.value( 0 ) == 7 );
+    EXPECT( v.error( 1 ) == "bad" );
+    EXPECT( v.value( 2 ) == 9 );
+    EXPECT( v.error( 3 ) == "worse" );
+}
+
+CASE( "expected_vector: Allows to emplace values and errors in place" )
+{
+    expected_vector<std::string, std::string> v;
+
+    v.emplace_back( 3u, 'a' );
+    v.emplace_error( 2u, 'e' );
+
+    EXPECT( v.value( 0 ) == "aaa" );
+    EXPECT( v.error( 1 ) == "ee"  );
+}
+
+CASE( "expected_vector: Keeps values dense, presence in a bitmap and errors in a sparse table" )
+{
+    auto v = make_mixed( 130 );
+
+    EXPECT( v.word_count() == 3u );
+    EXPECT( v.error_count() == 44u );
+    EXPECT( v.value_data()[ 1 ] == 1 );
+    EXPECT( v.value_data()[ 129 ] == 0 );
+    EXPECT( ( v.validity_data()[ 0 ] & 0x7u ) == 0x6u );
+    EXPECT( v.errors()[ 1 ].first == 3u );
+    EXPECT( v.errors()[ 1 ].second == "error 3" );
+}
+
+CASE( "expected_vector: Allows to append a range of expected" )
+{
+    std::vector< expected<int, std::string> > src;
+    src.push_back( 1 );
+    src.push_back( make_unexpected( std::string( "bad" ) ) );
+    src.push_back( 3 );
+
+    expected_vector<int, std::string> v;
+    v.append( src.begin(), src.end() );
+
+    EXPECT( v.size() == 3u );
+    EXPECT( v.value( 2 ) == 3 );
+    EXPECT( v.error( 1 ) == "bad" );
+}
+
+CASE( "expected_vector: Allows to append a range of values" )
+{
+    std::vector<int> src( 100, 7 );
+
+    expected_vector<int, std::string> v;
+    v.emplace_error( "first" );
+    v.append_values( src.begin(), src.end() );
+
+    EXPECT( v.size() == 101u );
+    EXPECT( v.value_count() == 100u );
+    EXPECT( ! v.has_value( 0 ) );
+    EXPECT( v.has_value( 1 ) );
+    EXPECT( v.has_value( 63 ) );
+    EXPECT( v.has_value( 64 ) );
+    EXPECT( v.has_value( 100 ) );
+    EXPECT( v.validity_data()[ 1 ] == 0x1fffffffffULL );
+}
+
+CASE( "expected_vector: Leaves its contents as they were if appending an element throws" )
+{
+    expected_vector<Fragile, std::string> v;
+
+    for ( int i = 0; i < 64; ++i )
+        v.push_back( Fragile( i ) );
+
+    Fragile::fail = true;
+    EXPECT_THROWS_AS( v.emplace_back( 64 ), std::runtime_error );
+    EXPECT_THROWS_AS( v.emplace_error( "bad" ), std::runtime_error );
+    Fragile::fail = false;
+
+    EXPECT( v.size() == 64u );
+    EXPECT( v.error_count() == 0u );
+
+    v.emplace_error( "bad" );
+    v.push_back( Fragile( 65 ) );
+
+    EXPECT( v.size() == 66u );
+    EXPECT( ! v.has_value( 64 ) );
+    EXPECT( v.has_value( 65 ) );
+    EXPECT( v[ 64 ].error() == "bad" );
+    EXPECT( v[ 65 ].value().v == 65 );
+}
+
+CASE( "expected_vector: Allows to access elements via an expected-like proxy" )
+{
+    auto v = make_mixed( 4 );
+
+    EXPECT( ! v[0] );
+    EXPECT(   v[1] );
+    EXPECT( v[0].error() == "error 0" );
+    EXPECT( *v[1] == 1 );
+    EXPECT( v[1].value() == 1 );
+    EXPECT( v[0].value_or( 42 ) == 42 );
+    EXPECT( v[2].value_or( 42 ) ==  2 );
+
+    *v[1] = 5;
+    v[0].error() = "changed";
+
+    EXPECT( v.value( 1 ) == 5 );
+    EXPECT( v.error( 0 ) == "changed" );
+}
+
+CASE( "expected_vector: Allows to convert an element to expected" )
+{
+    auto v = make_mixed( 2 );
+
+    expected<int, std::string> e0 = v[0];
+    expected<int, std::string> e1 = v.get( 1 );
+
+    EXPECT( e0.error() == "error 0" );
+    EXPECT( e1.value() == 1 );
+}
+
+CASE( "expected_vector: Allows to iterate over its elements" )
+{
+    auto const v = make_mixed( 10 );
+
+    int values = 0;
+    int errors = 0;
+
+    for ( auto e : v )
+    {
+        if ( e ) values += *e;
+        else     ++errors;
+    }
+
+    EXPECT( values == 1 + 2 + 4 + 5 + 7 + 8 );
+    EXPECT( errors == 4 );
+    EXPECT( v.end() - v.begin() == 10 );
+    EXPECT( (*( v.begin() + 4 )).index() == 4u );
+}
+
+CASE( "expected_vector: Throws bad_expected_access on value access of an error" )
+{
+    auto v = make_mixed( 2 );
+
+    EXPECT_THROWS_AS( v.value( 0 ), bad_expected_access<std::string> );
+    EXPECT_THROWS_AS( v[0].value(), bad_expected_access<std::string> );
+}
+
+CASE( "expected_vector: Throws std::out_of_range on at() beyond its size" )
+{
+    auto v = make_mixed( 2 );
+
+    EXPECT_THROWS_AS( v.at( 2 ), std::out_of_range );
+}
+
+CASE( "expected_vector: Allows to be cleared and swapped" )
+{
+    auto a = make_mixed( 5 );
+    auto b = make_mixed( 2 );
+
+    swap( a, b );
+
+    EXPECT( a.size() == 2u );
+    EXPECT( b.size() == 5u );
+
+    b.clear();
+
+    EXPECT( b.empty() );
+    EXPECT( b.error_count() == 0u );
+}
+
+// end of file
@@ -100,6 +100,74 @@ std::ostream & operator<<( std::ostream & os, OracleVal const & o )
     return os << "[oracle:" << to_string( o.i ) << "]";
 }
 
+/// operations on the Counted instances of a type, see below.
+
+struct Counts
+{
+    int constructed;
+    int copy_constructed;
+    int move_constructed;
+    int copy_assigned;
+    int move_assigned;
+    int destructed;
+
+    bool operator==( Counts const & other ) const
+    {
+        return constructed      == other.constructed
+            && copy_constructed == other.copy_constructed
+            && move_constructed == other.move_constructed
+            && copy_assigned    == other.copy_assigned
+            && move_assigned    == other.move_assigned
+            && destructed       == other.destructed;
+    }
+};
+
+std::ostream & operator<<( std::ostream & os, Counts const & c )
+{
+    return os << "[counts: ctor:" << c.constructed << " copy:" << c.copy_constructed << " move:" << c.move_constructed
+        << " copy=:" << c.copy_assigned << " move=:" << c.move_assigned << " dtor:" << c.destructed << "]";
+}
+
+/// payload that counts its constructions, copies, moves, assignments and
+/// destructions per Tag, to check that expected does not copy or move more
+/// than its operations need.
+
+template< typename Tag >
+struct Counted
+{
+    static Counts counts;
+    int x;
+
+    Counted( int v = 0 ) noexcept : x( v ) { ++counts.constructed; }
+    Counted( Counted const & other ) : x( other.x ) { ++counts.copy_constructed; }
+    Counted( Counted && other ) noexcept : x( other.x ) { ++counts.move_constructed; }
+
+    Counted & operator=( Counted const & other ) { x = other.x; ++counts.copy_assigned; return *this; }
+    Counted & operator=( Counted && other ) noexcept { x = other.x; ++counts.move_assigned; return *this; }
+
+    ~Counted() { ++counts.destructed; }
+
+    bool operator==( Counted const & other ) const { return x == other.x; }
+};
+
+template< typename Tag >
+Counts Counted<Tag>::counts;
+
+template< typename Tag >
+std::ostream & operator<<( std::ostream & os, Counted<Tag> const & c )
+{
+    return os << "[counted:" << c.x << "]";
+}
+
+using CountedValue = Counted< struct counted_value_tag >;
+using CountedError = Counted< struct counted_error_tag >;
+
+void reset_counts()
+{
+    CountedValue::counts = Counts();
+    CountedError::counts = Counts();
+}
+
 //} // anonymous namespace
 
 namespace nonstd {
@@ -1619,6 +1687,856 @@ CASE( "std::hash: Allows to compute hash value for expected" )
     EXPECT( (std::hash< expected<int, char> >{}( a )) == (std::hash< expected<int, char> >{}( b )) );
 }
 
+// -----------------------------------------------------------------------
+// expected in constant expressions (C++20)
+
+#if nsel_HAVE_CONSTEXPR_20
+
+namespace constexpr20 {
+
+constexpr expected<int, int> half( int x )
+{
+    if ( x % 2 )
+        return make_unexpected( x );
+
+    return x / 2;
+}
+
+struct halves
+{
+    expected<int, int> entry[ 4 ];
+};
+
+constexpr halves make_halves()
+{
+    halves table{};
+
+    for ( int i = 0; i < 4; ++i )
+        table.entry[ i ] = half( i );
+
+    return table;
+}
+
+constexpr halves table = make_halves();
+
+constexpr int assign_emplace_swap()
+{
+    expected<int, int> a{ 1 };
+    expected<int, int> b{ unexpect, 2 };
+
+    a.swap( b );
+    const int swapped = a.error() * 10 + *b;
+
+    a.emplace( 3 );
+    b = a;
+    b = make_unexpected( 4 );
+
+    return swapped * 100 + *a * 10 + b.error();
+}
+
+constexpr int void_assign_emplace_swap()
+{
+    expected<void, int> a;
+    expected<void, int> b{ unexpect, 2 };
+
+    a.swap( b );
+    const int swapped = a.error();
+
+    a.emplace();
+    b = a;
+
+    return swapped * 10 + a.has_value() + b.has_value();
+}
+
+// a value type with non-trivial special members:
+
+struct text
+{
+    int length;
+
+    constexpr text( int n ) : length( n ) {}
+    constexpr text( text const & other ) : length( other.length ) {}
+    constexpr text & operator=( text const & other ) { length = other.length; return *this; }
+    constexpr ~text() {}
+};
+
+constexpr int non_trivial_value()
+{
+    expected<text, int> s{ 3 };
+    expected<text, int> u{ unexpect, 1 };
+
+    s.swap( u );
+    s = std::move( u );
+
+    return s->length;
+}
+
+} // namespace constexpr20
+
+#endif // nsel_HAVE_CONSTEXPR_20
+
+CASE( "expected: Allows a table of expected to be computed at compile time (C++20)" )
+{
+#if nsel_HAVE_CONSTEXPR_20
+    static_assert( constexpr20::table.entry[ 0 ].value() == 0, "" );
+    static_assert( constexpr20::table.entry[ 1 ].error() == 1, "" );
+    static_assert( constexpr20::table.entry[ 2 ].value() == 1, "" );
+    static_assert( constexpr20::table.entry[ 3 ].error() == 3, "" );
+
+    EXPECT( constexpr20::table.entry[ 2 ] == 1 );
+#else
+    EXPECT( !!"expected is not usable in constant expressions (no C++20)." );
+#endif
+}
+
+CASE( "expected: Allows to assign, emplace and swap in a constant expression (C++20)" )
+{
+#if nsel_HAVE_CONSTEXPR_20
+    constexpr int result = constexpr20::assign_emplace_swap();
+    constexpr int result_void = constexpr20::void_assign_emplace_swap();
+    constexpr int length = constexpr20::non_trivial_value();
+
+    EXPECT( result == 2134 );
+    EXPECT( result_void == 22 );
+    EXPECT( length == 3 );
+#else
+    EXPECT( !!"expected is not usable in constant expressions (no C++20)." );
+#endif
+}
+
+CASE( "expected: Has trivial special members when its value and error types have (C++20)" )
+{
+#if nsel_HAVE_CONDITIONALLY_TRIVIAL
+    EXPECT((  std::is_trivially_copyable< expected<int , int> >::value ));
+    EXPECT((  std::is_trivially_copyable< expected<void, int> >::value ));
+    EXPECT((  std::is_trivially_destructible< expected<int, int> >::value ));
+    EXPECT(( !std::is_trivially_copyable< expected<std::string, int> >::value ));
+    EXPECT(( !std::is_trivially_destructible< expected<int, std::string> >::value ));
+    EXPECT((  std::is_copy_assignable< expected<std::string, int> >::value ));
+#else
+    EXPECT( !!"expected has no conditionally trivial special members (no C++20)." );
+#endif
+}
+
+// -----------------------------------------------------------------------
+// expected<>: operation counts of value and error
+//
+// Counts{} lists: constructed, copy-, move-constructed, copy-, move-assigned,
+// destructed; only the operations of the statement under test are counted.
+
+namespace {
+
+using counted_expected      = expected<CountedValue, CountedError>;
+using counted_expected_void = expected<void, CountedError>;
+
+}
+
+CASE( "expected: Copies or moves its value or error once on construction" )
+{
+    SETUP("") {
+
+    CountedValue v{ 1 };
+    unexpected_type<CountedError> u{ CountedError{ 2 } };
+
+    SECTION("from value, copy")
+    {
+        reset_counts();
+        counted_expected x( v );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 1, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("from value, move")
+    {
+        reset_counts();
+        counted_expected x( std::move( v ) );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("from value, in place")
+    {
+        reset_counts();
+        counted_expected x( nonstd_lite_in_place(CountedValue), 1 );
+
+        EXPECT(( CountedValue::counts == Counts{ 1, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("from unexpected, copy")
+    {
+        reset_counts();
+        counted_expected x( u );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 1, 0, 0, 0, 0 } ));
+    }
+    SECTION("from unexpected, move")
+    {
+        reset_counts();
+        counted_expected x( std::move( u ) );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 1, 0, 0, 0 } ));
+    }
+    SECTION("from error, in place")
+    {
+        reset_counts();
+        counted_expected x( unexpect, 2 );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 1, 0, 0, 0, 0, 0 } ));
+    }
+    }
+}
+
+CASE( "expected: Copies or moves its value or error once on copy- and move-construction" )
+{
+    SETUP("") {
+
+    counted_expected ev{ 1 };
+    counted_expected ee{ unexpect, 2 };
+
+    SECTION("value, copy")
+    {
+        reset_counts();
+        counted_expected x( ev );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 1, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("value, move")
+    {
+        reset_counts();
+        counted_expected x( std::move( ev ) );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("error, copy")
+    {
+        reset_counts();
+        counted_expected x( ee );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 1, 0, 0, 0, 0 } ));
+    }
+    SECTION("error, move")
+    {
+        reset_counts();
+        counted_expected x( std::move( ee ) );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 1, 0, 0, 0 } ));
+    }
+    }
+}
+
+CASE( "expected: Copies and swaps on assignment from expected in the same state" )
+{
+    SETUP("") {
+
+    counted_expected ev1{ 1 };
+    counted_expected ev2{ 2 };
+    counted_expected ee1{ unexpect, 1 };
+    counted_expected ee2{ unexpect, 2 };
+
+    SECTION("value, copy")
+    {
+        reset_counts();
+        ev1 = ev2;
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 1, 1, 0, 2, 2 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("value, move")
+    {
+        reset_counts();
+        ev1 = std::move( ev2 );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 2, 0, 2, 2 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("error, copy")
+    {
+        reset_counts();
+        ee1 = ee2;
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 1, 1, 0, 2, 2 } ));
+    }
+    SECTION("error, move")
+    {
+        reset_counts();
+        ee1 = std::move( ee2 );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 2, 2 } ));
+    }
+    }
+}
+
+CASE( "expected: Copies and swaps on assignment from expected in the other state" )
+{
+    SETUP("") {
+
+    counted_expected ev{ 1 };
+    counted_expected ee{ unexpect, 2 };
+
+    SECTION("value to error, copy")
+    {
+        reset_counts();
+        ee = ev;
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 1, 1, 0, 0, 1 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 0, 3 } ));
+    }
+    SECTION("value to error, move")
+    {
+        reset_counts();
+        ee = std::move( ev );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 2, 0, 0, 1 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 0, 3 } ));
+    }
+    SECTION("error to value, copy")
+    {
+        reset_counts();
+        ev = ee;
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 2 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 1, 2, 0, 0, 2 } ));
+    }
+    SECTION("error to value, move")
+    {
+        reset_counts();
+        ev = std::move( ee );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 2 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 3, 0, 0, 2 } ));
+    }
+    }
+}
+
+CASE( "expected: Assigns its value via a temporary on assignment from value" )
+{
+    SETUP("") {
+
+    counted_expected ev{ 1 };
+    counted_expected ee{ unexpect, 2 };
+    CountedValue v{ 3 };
+
+    SECTION("to value, copy")
+    {
+        reset_counts();
+        ev = v;
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 1, 2, 0, 2, 3 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("to value, move")
+    {
+        reset_counts();
+        ev = std::move( v );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 3, 0, 2, 3 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("to error, copy")
+    {
+        reset_counts();
+        ee = v;
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 1, 2, 0, 0, 2 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 0, 3 } ));
+    }
+    SECTION("to error, move")
+    {
+        reset_counts();
+        ee = std::move( v );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 3, 0, 0, 2 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 0, 3 } ));
+    }
+    }
+}
+
+CASE( "expected: Copies and swaps on assignment from unexpected" )
+{
+    SETUP("") {
+
+    counted_expected ev{ 1 };
+    counted_expected ee{ unexpect, 2 };
+    unexpected_type<CountedError> u{ CountedError{ 3 } };
+
+    SECTION("to value, copy")
+    {
+        reset_counts();
+        ev = u;
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 2 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 1, 2, 0, 0, 2 } ));
+    }
+    SECTION("to value, move")
+    {
+        reset_counts();
+        ev = std::move( u );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 2 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 3, 0, 0, 2 } ));
+    }
+    SECTION("to error, copy")
+    {
+        reset_counts();
+        ee = u;
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 1, 1, 0, 2, 2 } ));
+    }
+    SECTION("to error, move")
+    {
+        reset_counts();
+        ee = std::move( u );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 2, 2 } ));
+    }
+    }
+}
+
+CASE( "expected: Constructs its value into a temporary and swaps on emplace()" )
+{
+    SETUP("") {
+
+    counted_expected ev{ 1 };
+    counted_expected ee{ unexpect, 2 };
+
+    SECTION("to value")
+    {
+        reset_counts();
+        ev.emplace( 3 );
+
+        EXPECT(( CountedValue::counts == Counts{ 1, 0, 1, 0, 2, 2 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("to error")
+    {
+        reset_counts();
+        ee.emplace( 3 );
+
+        EXPECT(( CountedValue::counts == Counts{ 1, 0, 1, 0, 0, 1 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 0, 3 } ));
+    }
+    }
+}
+
+CASE( "expected: Moves its value or error at most twice on swap()" )
+{
+    SETUP("") {
+
+    counted_expected ev1{ 1 };
+    counted_expected ev2{ 2 };
+    counted_expected ee1{ unexpect, 1 };
+    counted_expected ee2{ unexpect, 2 };
+
+    SECTION("value-value")
+    {
+        reset_counts();
+        ev1.swap( ev2 );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 2, 1 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+    }
+    SECTION("error-error")
+    {
+        reset_counts();
+        ee1.swap( ee2 );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 0, 0, 0, 0 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 1, 0, 2, 1 } ));
+    }
+    SECTION("value-error")
+    {
+        reset_counts();
+        ev1.swap( ee1 );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 1 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 0, 2 } ));
+    }
+    SECTION("error-value")
+    {
+        reset_counts();
+        ee1.swap( ev1 );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 1 } ));
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 0, 2 } ));
+    }
+    }
+}
+
+CASE( "expected: Moves its value once on value_or() && (C++17)" )
+{
+#if nsel_CPP17_OR_GREATER
+    SETUP("") {
+
+    counted_expected ev{ 1 };
+    counted_expected ee{ unexpect, 2 };
+
+    SECTION("value")
+    {
+        reset_counts();
+        CountedValue v = std::move( ev ).value_or( 3 );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 0 } ));
+        EXPECT(  v.x == 1 );
+    }
+    SECTION("error")
+    {
+        reset_counts();
+        CountedValue v = std::move( ee ).value_or( 3 );
+
+        EXPECT(( CountedValue::counts == Counts{ 1, 0, 0, 0, 0, 0 } ));
+        EXPECT(  v.x == 3 );
+    }
+    }
+#else
+    EXPECT( !!"Copy elision of the returned value is not guaranteed (no C++17)." );
+#endif
+}
+
+CASE( "expected: Moves its value or error once in factories (C++17)" )
+{
+#if nsel_CPP17_OR_GREATER
+    SETUP("") {
+
+    CountedValue v{ 1 };
+    CountedError e{ 2 };
+
+    SECTION("make_unexpected()")
+    {
+        reset_counts();
+        auto u = make_unexpected( std::move( e ) );
+
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 1, 0, 0, 0 } ));
+        EXPECT(  u.value().x == 2 );
+    }
+    SECTION("expected from make_unexpected()")
+    {
+        reset_counts();
+        counted_expected x = make_unexpected( std::move( e ) );
+
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 0, 1 } ));
+        EXPECT(  x.error().x == 2 );
+    }
+    SECTION("make_expected()")
+    {
+#if nsel_P0323R <= 3
+        reset_counts();
+        auto x = make_expected( std::move( v ) );
+
+        EXPECT(( CountedValue::counts == Counts{ 0, 0, 1, 0, 0, 0 } ));
+        EXPECT(  x.value().x == 1 );
+#else
+        EXPECT( !!"make_expected() is not available (nsel_P0323R > 3)" );
+#endif
+    }
+    SECTION("make_expected_from_error()")
+    {
+#if nsel_P0323R <= 3
+        reset_counts();
+        auto x = make_expected_from_error<CountedValue>( std::move( e ) );
+
+        EXPECT(( CountedError::counts == Counts{ 0, 1, 2, 0, 0, 2 } ));
+        EXPECT(  x.error().x == 2 );
+#else
+        EXPECT( !!"make_expected_from_error() is not available (nsel_P0323R > 3)" );
+#endif
+    }
+    }
+#else
+    EXPECT( !!"Copy elision of the returned value is not guaranteed (no C++17)." );
+#endif
+}
+
+CASE( "expected<void>: Copies and swaps its error on assignment and emplace(), moves it on swap()" )
+{
+    SETUP("") {
+
+    counted_expected_void ev;
+    counted_expected_void ee1{ unexpect, 1 };
+    counted_expected_void ee2{ unexpect, 2 };
+
+    SECTION("error to error, copy")
+    {
+        reset_counts();
+        ee1 = ee2;
+
+        EXPECT(( CountedError::counts == Counts{ 0, 1, 1, 0, 2, 2 } ));
+    }
+    SECTION("error to value, move")
+    {
+        reset_counts();
+        ev = std::move( ee1 );
+
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 2, 0, 0, 1 } ));
+    }
+    SECTION("value to error, move")
+    {
+        reset_counts();
+        ee1 = std::move( ev );
+
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 1, 0, 0, 2 } ));
+    }
+    SECTION("emplace() to error")
+    {
+        reset_counts();
+        ee1.emplace();
+
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 1, 0, 0, 2 } ));
+    }
+    SECTION("swap() value-error")
+    {
+        reset_counts();
+        ev.swap( ee1 );
+
+        EXPECT(( CountedError::counts == Counts{ 0, 0, 1, 0, 0, 1 } ));
+    }
+    }
+}
+
+// -----------------------------------------------------------------------
+// boxed<>, out-of-line error storage
+
+namespace {
+
+struct Diag
+{
+    int code;
+    char text[200];
+
+    Diag( int c = 0 ) : code( c ), text() {}
+};
+
+bool operator==( Diag const & a, Diag const & b ) { return a.code == b.code; }
+
+std::ostream & operator<<( std::ostream & os, Diag const & d ) { return os << "[diag:" << d.code << "]"; }
+
+struct BoxedDiag : Diag
+{
+    BoxedDiag( int c = 0 ) : Diag( c ) {}
+};
+
+int allocations = 0;
+
+template< typename T >
+struct CountingAllocator
+{
+    using value_type = T;
+
+    CountingAllocator() = default;
+    template< typename U > CountingAllocator( CountingAllocator<U> const & ) {}
+
+    T * allocate( std::size_t n ) { ++allocations; return std::allocator<T>().allocate( n ); }
+    void deallocate( T * p, std::size_t n ) { --allocations; std::allocator<T>().deallocate( p, n ); }
+};
+
+template< typename T, typename U >
+bool operator==( CountingAllocator<T> const &, CountingAllocator<U> const & ) { return true; }
+
+template< typename T, typename U >
+bool operator!=( CountingAllocator<T> const &, CountingAllocator<U> const & ) { return false; }
+
+} // anonymous namespace
+
+namespace nonstd { namespace expected_lite {
+
+template<> struct is_boxed_error< BoxedDiag > : std::true_type {};
+
+template<> struct boxed_error_allocator< BoxedDiag > { using type = CountingAllocator< BoxedDiag >; };
+
+}} // namespace nonstd::expected_lite
+
+CASE( "boxed: Allows to construct from error_type" )
+{
+    boxed<Diag> b{ Diag{ 7 } };
+
+    EXPECT( b->code == 7 );
+    EXPECT( b.get() == Diag{ 7 } );
+}
+
+CASE( "boxed: Allows to in-place-construct" )
+{
+    boxed<Diag> b{ in_place, 7 };
+
+    EXPECT( (*b).code == 7 );
+}
+
+CASE( "boxed: Allows to copy-construct, copying the error" )
+{
+    boxed<Diag> a{ Diag{ 7 } };
+    boxed<Diag> b{ a };
+
+    EXPECT( b->code == 7 );
+    EXPECT( &*a != &*b  );
+}
+
+CASE( "boxed: Allows to move-construct, leaving the source valueless" )
+{
+    boxed<Diag> a{ Diag{ 7 } };
+    Diag * p = &*a;
+
+    boxed<Diag> b{ std::move( a ) };
+
+    EXPECT( &*b == p );
+    EXPECT(  a.valueless_after_move() );
+    EXPECT( !b.valueless_after_move() );
+}
+
+CASE( "boxed: Compares a valueless boxed equal only to another valueless one" )
+{
+    boxed<Diag> a{ Diag{ 7 } };
+    boxed<Diag> b{ Diag{ 7 } };
+    boxed<Diag> c{ std::move( a ) };
+    boxed<Diag> d{ std::move( b ) };
+
+    EXPECT( ( a == b ) );
+    EXPECT( ( a != c ) );
+    EXPECT( ( c != a ) );
+    EXPECT( ( c == d ) );
+}
+
+CASE( "boxed: Allows to be swapped" )
+{
+    boxed<Diag> a{ Diag{ 5 } };
+    boxed<Diag> b{ Diag{ 7 } };
+
+    swap( a, b );
+
+    EXPECT( a->code == 7 );
+    EXPECT( b->code == 5 );
+}
+
+CASE( "boxed: Allocates and releases via the given allocator" )
+{
+    allocations = 0;
+    {
+        boxed<Diag, CountingAllocator<Diag> > a{ Diag{ 7 } };
+        boxed<Diag, CountingAllocator<Diag> > b{ a };
+
+        EXPECT( allocations == 2 );
+    }
+    EXPECT( allocations == 0 );
+}
+
+CASE( "expected: Allows to use boxed<E> as error type" )
+{
+    expected<int, boxed<Diag> > e{ make_unexpected( Diag{ 7 } ) };
+
+    EXPECT( sizeof( e ) < sizeof( Diag ) );
+    EXPECT( e.error()->code == 7 );
+}
+
+CASE( "expected: Holds an error out of line if is_boxed_error<E>" )
+{
+    EXPECT( sizeof( expected<int, BoxedDiag> ) <  sizeof( BoxedDiag ) );
+#if nsel_CONFIG_BOXED_ERROR_THRESHOLD == 0
+    EXPECT( sizeof( expected<int, Diag     > ) >= sizeof( Diag      ) );
+#endif
+}
+
+CASE( "expected: Allows to construct, copy, move, swap and destroy a boxed error" )
+{
+    allocations = 0;
+    {
+        expected<int, BoxedDiag> a{ unexpect, 7 };
+        expected<int, BoxedDiag> b{ a };
+        expected<int, BoxedDiag> c{ std::move( b ) };
+        expected<int, BoxedDiag> d{ 42 };
+
+        EXPECT( allocations == 3 );
+        EXPECT( a.error().code == 7 );
+        EXPECT( c.error().code == 7 );
+
+        d.swap( c );
+
+        EXPECT( c.value() == 42 );
+        EXPECT( d.error().code == 7 );
+        EXPECT( allocations == 3 );
+
+        d = 3;
+
+        EXPECT( d.value() == 3 );
+        EXPECT( allocations == 2 );
+    }
+    EXPECT( allocations == 0 );
+}
+
+CASE( "expected: Leaves a valid boxed error on move" )
+{
+    allocations = 0;
+    {
+        expected<int, BoxedDiag> a{ 1 };
+        expected<int, BoxedDiag> c{ unexpect, 5 };
+
+        a = make_unexpected( BoxedDiag{ 7 } );
+        expected<int, BoxedDiag> b{ std::move( a ) };
+
+        EXPECT( a.error().code == 7 );
+        EXPECT( b.error().code == 7 );
+        EXPECT( a == b );
+
+        a = c;
+
+        EXPECT( a.error().code == 5 );
+
+        a = std::move( b );
+
+        EXPECT( a.error().code == 7 );
+        EXPECT( b.error().code == 7 );
+        EXPECT( allocations == 3 );
+    }
+    EXPECT( allocations == 0 );
+}
+
+CASE( "expected: Swaps a boxed error with a value without allocating" )
+{
+    EXPECT(  noexcept( std::declval< expected<int, BoxedDiag> & >().swap( std::declval< expected<int, BoxedDiag> & >() ) ) );
+    EXPECT( !noexcept( std::declval< expected<int, BoxedDiag> & >() = std::declval< expected<int, BoxedDiag> >() ) );
+
+    allocations = 0;
+    {
+        expected<int, BoxedDiag> a{ unexpect, 7 };
+        expected<int, BoxedDiag> b{ 42 };
+        BoxedDiag const * p = &a.error();
+
+        a.swap( b );
+
+        EXPECT( &b.error() == p );
+        EXPECT( a.value() == 42 );
+        EXPECT( allocations == 1 );
+    }
+    EXPECT( allocations == 0 );
+}
+
+CASE( "expected<void>: Allows to construct, copy, move, swap and destroy a boxed error" )
+{
+    allocations = 0;
+    {
+        expected<void, BoxedDiag> a{ unexpect, 7 };
+        expected<void, BoxedDiag> b{ a };
+        expected<void, BoxedDiag> c;
+
+        EXPECT( sizeof( a ) < sizeof( BoxedDiag ) );
+        EXPECT( allocations == 2 );
+
+        c.swap( b );
+
+        EXPECT( b.has_value() );
+        EXPECT( c.error().code == 7 );
+        EXPECT( allocations == 2 );
+    }
+    EXPECT( allocations == 0 );
+}
+
 #if nsel_P0323R <= 3
 
 #include <memory>
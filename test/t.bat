@@ -29,7 +29,7 @@ set msvc_defines=^
 
 set CppCoreCheckInclude=%VCINSTALLDIR%\Auxiliary\VS\include
 
-cl -nologo -W3 -EHsc %std% %unit_select% %unit_config% %msvc_defines% -I"%CppCoreCheckInclude%" -Ilest -I../include -I. %unit%-main.t.cpp %unit%.t.cpp && %unit%-main.t.exe
+cl -nologo -W3 -EHsc %std% %unit_select% %unit_config% %msvc_defines% -I"%CppCoreCheckInclude%" -Ilest -I../include -I. %unit%-main.t.cpp %unit%.t.cpp %unit%-vector.t.cpp %unit%-simd.t.cpp %unit%-algorithm.t.cpp %unit%-parallel.t.cpp %unit%-validated.t.cpp %unit%-coroutine.t.cpp %unit%-slot.t.cpp %unit%-atomic.t.cpp %unit%-queue.t.cpp %unit%-pool.t.cpp %unit%-sender.t.cpp %unit%-deadline.t.cpp %unit%-fwd.t.cpp && %unit%-main.t.exe
 endlocal & goto :EOF
 
 :: subroutines:
@@ -34,7 +34,7 @@ rem -flto / -fwhole-program
 set  optflags=-O2
 set warnflags=-Wall -Wextra -Wpedantic -Weverything -Wshadow -Wno-c++98-compat -Wno-c++98-compat-pedantic -Wno-padded -Wno-missing-noreturn -Wno-documentation-unknown-command -Wno-documentation-deprecated-sync -Wno-documentation -Wno-weak-vtables -Wno-missing-prototypes -Wno-missing-variable-declarations -Wno-exit-time-destructors -Wno-global-constructors -Wno-sign-conversion -Wno-sign-compare -Wno-implicit-int-conversion -Wno-deprecated-declarations -Wno-date-time
 
-"%clang%" -EHsc -std:%std% %optflags% %warnflags% %unit_config% -fms-compatibility-version=19.00 /imsvc lest -I../include -Ics_string -I. -o %unit_file%-main.t.exe %unit_file%-main.t.cpp %unit_file%.t.cpp && %unit_file%-main.t.exe
+"%clang%" -EHsc -std:%std% %optflags% %warnflags% %unit_config% -fms-compatibility-version=19.00 /imsvc lest -I../include -Ics_string -I. -o %unit_file%-main.t.exe %unit_file%-main.t.cpp %unit_file%.t.cpp %unit_file%-vector.t.cpp %unit_file%-simd.t.cpp %unit_file%-algorithm.t.cpp %unit_file%-parallel.t.cpp %unit_file%-validated.t.cpp %unit_file%-coroutine.t.cpp %unit_file%-slot.t.cpp %unit_file%-atomic.t.cpp %unit_file%-queue.t.cpp %unit_file%-pool.t.cpp %unit_file%-sender.t.cpp %unit_file%-deadline.t.cpp %unit_file%-fwd.t.cpp && %unit_file%-main.t.exe
 endlocal & goto :EOF
 
 :: subroutines:
@@ -29,7 +29,7 @@ rem -flto / -fwhole-program
 set  optflags=-O2
 set warnflags=-Wall -Wextra -Wpedantic -Wconversion -Wsign-conversion -Wno-padded -Wno-missing-noreturn
 
-%gpp% -std=%std% %optflags% %warnflags% %unit_select% %unit_config% -o %unit%-main.t.exe -Dlest_FEATURE_AUTO_REGISTER=1 -isystem lest -I../include -I. %unit%-main.t.cpp %unit%.t.cpp && %unit%-main.t.exe
+%gpp% -std=%std% %optflags% %warnflags% %unit_select% %unit_config% -o %unit%-main.t.exe -Dlest_FEATURE_AUTO_REGISTER=1 -isystem lest -I../include -I. %unit%-main.t.cpp %unit%.t.cpp %unit%-vector.t.cpp %unit%-simd.t.cpp %unit%-algorithm.t.cpp %unit%-parallel.t.cpp %unit%-validated.t.cpp %unit%-coroutine.t.cpp %unit%-slot.t.cpp %unit%-atomic.t.cpp %unit%-queue.t.cpp %unit%-pool.t.cpp %unit%-sender.t.cpp %unit%-deadline.t.cpp %unit%-fwd.t.cpp && %unit%-main.t.exe
 
 endlocal & goto :EOF
 